@@ -0,0 +1,39 @@
+// Check that a defparam into a scope that is made by a later
+// elaboration pass is applied, and that the parameters that depend
+// on it are evaluated, while the other scopes keep their values.
+
+module leaf;
+  parameter P = 1;
+  localparam Q = P * 2;
+endmodule
+
+module mid #(parameter N = 1);
+  genvar i;
+  generate
+    for (i = 0 ; i < N ; i = i + 1) begin : g
+      if (i == N-1) begin : last
+        leaf u();
+      end
+    end
+  endgenerate
+endmodule
+
+module top;
+  mid #(.N(3)) m1();
+  mid #(.N(2)) m2();
+
+  defparam m1.g[2].last.u.P = 21;
+
+  initial begin
+    #1;
+    if (m1.g[2].last.u.P !== 21 || m1.g[2].last.u.Q !== 42) begin
+      $display("FAILED: m1 P=%0d Q=%0d", m1.g[2].last.u.P, m1.g[2].last.u.Q);
+      $finish;
+    end
+    if (m2.g[1].last.u.P !== 1 || m2.g[1].last.u.Q !== 2) begin
+      $display("FAILED: m2 P=%0d Q=%0d", m2.g[1].last.u.P, m2.g[1].last.u.Q);
+      $finish;
+    end
+    $display("PASSED");
+  end
+endmodule
@@ -0,0 +1,10 @@
+module top;
+  reg [3:0] cnt;
+
+  initial begin
+    cnt = 0;
+    $flightrecorder(3, top);
+    repeat (10) #1 cnt = cnt + 1;
+    #1 $flightdump("work/flight.vcd");
+  end
+endmodule
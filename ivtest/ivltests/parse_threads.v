@@ -0,0 +1,36 @@
+// Check that a design gives the same output when vvp scans the design
+// file on several threads. The chain of cells makes enough scopes and
+// functors that -parse-threads=4 cuts the file into several chunks.
+// parse_threads4 runs this same design with 4 threads.
+
+module cell #(parameter K = 0) (input [7:0] a, output [7:0] y);
+   assign y = (a ^ K) + K;
+endmodule
+
+module main;
+   localparam N = 32;
+
+   reg [7:0] a;
+   wire [8*(N+1)-1:0] chain;
+
+   assign chain[7:0] = a;
+
+   genvar i;
+   for (i = 0 ; i < N ; i = i + 1) begin : g
+      cell #(.K(i*7+1)) u (.a(chain[8*i +: 8]), .y(chain[8*(i+1) +: 8]));
+   end
+
+   initial begin
+      a = 0;
+      #1 $display("a=%0d y=%0d", a, chain[8*N +: 8]);
+      a = 1;
+      #1 $display("a=%0d y=%0d", a, chain[8*N +: 8]);
+      a = 85;
+      #1 $display("a=%0d y=%0d", a, chain[8*N +: 8]);
+      a = 200;
+      #1 $display("a=%0d y=%0d", a, chain[8*N +: 8]);
+      a = 255;
+      #1 $display("a=%0d y=%0d", a, chain[8*N +: 8]);
+   end
+
+endmodule
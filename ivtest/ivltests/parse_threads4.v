@@ -0,0 +1,2 @@
+// Run parse_threads.v with the design file scanned on 4 threads.
+`include "ivltests/parse_threads.v"
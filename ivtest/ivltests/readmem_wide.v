@@ -0,0 +1,56 @@
+// Check $writememh/$writememb and $readmemh/$readmemb with wide words
+// that hold x and z bits, with enough words that the file is loaded in
+// more than one chunk, and with a decreasing address range.
+module main;
+
+   localparam N = 40000;
+
+   reg [99:0] src [0:N-1];
+   reg [99:0] dst [0:N-1];
+   reg [99:0] val;
+   reg	      error;
+   integer    idx;
+
+   function [99:0] word(input integer i);
+      begin
+	 word = {i[31:0], ~i[31:0], 4'b01xz, i[31:0]};
+	 if (i % 7 == 0) word[97:96] = 2'bzx;
+	 if (i % 11 == 0) word = 100'bz;
+      end
+   endfunction
+
+   initial begin
+      error = 0;
+      for (idx = 0 ; idx < N ; idx = idx + 1)
+	src[idx] = word(idx);
+
+      $writememh("work/readmem_wide.dat", src);
+      $readmemh("work/readmem_wide.dat", dst);
+      for (idx = 0 ; idx < N ; idx = idx + 1)
+	if (dst[idx] !== src[idx]) begin
+	   $display("FAILED: h dst[%0d] = %h, expect %h", idx, dst[idx], src[idx]);
+	   error = 1;
+	end
+
+      $writememb("work/readmem_wide.dat", src, N-1, 0);
+      for (idx = 0 ; idx < N ; idx = idx + 1)
+	dst[idx] = 100'bx;
+      $readmemb("work/readmem_wide.dat", dst);
+      for (idx = 0 ; idx < N ; idx = idx + 1)
+	if (dst[idx] !== src[N-1-idx]) begin
+	   $display("FAILED: b dst[%0d] = %h, expect %h", idx, dst[idx], src[N-1-idx]);
+	   error = 1;
+	end
+
+      $readmemb("work/readmem_wide.dat", dst, N-1, 0);
+      for (idx = 0 ; idx < N ; idx = idx + 1)
+	if (dst[idx] !== src[idx]) begin
+	   $display("FAILED: r dst[%0d] = %h, expect %h", idx, dst[idx], src[idx]);
+	   error = 1;
+	end
+
+      if (error == 0)
+	$display("PASSED");
+   end
+
+endmodule
@@ -0,0 +1,46 @@
+module top;
+  reg [299:0] val, res;
+  reg signed [149:0] sval, sres;
+  reg [799:0] str;
+  integer cnt;
+  reg pass;
+
+  initial begin
+    pass = 1'b1;
+
+    // A value wide enough to need many base 10^9 digits.
+    val = 300'h981892f902bd23f0824128b2f330c5c7fd0a6a3a4506513270e269e0d37f2a74de452e6b438;
+    $sformat(str, "%0d", val);
+    if (str !== "1210253940758746491861590463352636745112919533915436687254805734602130375354703937316238392") begin
+      $display("FAILED: %0d formatted as %0s", val, str);
+      pass = 1'b0;
+    end
+    cnt = $sscanf(str, "%d", res);
+    if (cnt !== 1 || res !== val) begin
+      $display("FAILED: $sscanf() of %0s gave %h", str, res);
+      pass = 1'b0;
+    end
+
+    // A negative signed value.
+    sval = -150'd724236542086395354974868621649978125656639992;
+    $sformat(str, "%0d", sval);
+    if (str !== "-724236542086395354974868621649978125656639992") begin
+      $display("FAILED: %0d formatted as %0s", sval, str);
+      pass = 1'b0;
+    end
+    cnt = $sscanf(str, "%d", sres);
+    if (cnt !== 1 || sres !== sval) begin
+      $display("FAILED: $sscanf() of %0s gave %h", str, sres);
+      pass = 1'b0;
+    end
+
+    // A value that does not fit is truncated to the width.
+    cnt = $sscanf("1210253940758746491861590463352636745112919533915436687254805734602130375354703937316238392", "%d", sres);
+    if (cnt !== 1 || sres !== val[149:0]) begin
+      $display("FAILED: $sscanf() truncated to %h", sres);
+      pass = 1'b0;
+    end
+
+    if (pass) $display("PASSED");
+  end
+endmodule
@@ -31,6 +31,9 @@ our (@testlist, %srcpath, %testtype, %args, %plargs,
 #
 #  test_name type,opt_ivl_args test_dir opt_module_name log/gold_file
 #
+#  The arguments that start with + are plusargs for vvp, and those that
+#  start with vvp: are passed to vvp without the prefix.
+#
 #  type can be:
 #    normal
 #    CO = compile only.
@@ -86,16 +89,10 @@ sub read_regression_list {
         # arguments with a space.
         if ($fields[1] =~ ',') {
             ($testtype{$tname},$args{$tname}) = split(',', $fields[1], 2);
-            if ($args{$tname} =~ ',') {
-                my @args = split(',', $args{$tname});
-                $plargs{$tname} = join(' ', grep(/^\+/, @args));
-                $args{$tname} = join(' ', grep(!/^\+/, @args));
-            } elsif ($args{$tname} =~ /^\+/) {
-                $plargs{$tname} = $args{$tname};
-                $args{$tname} = "";
-            } else {
-                $plargs{$tname} = "";
-            }
+            my @args = split(',', $args{$tname});
+            $args{$tname} = join(' ', grep(!/^(\+|vvp:)/, @args));
+            my @vvp_args = map { s/^vvp://r } grep(/^(\+|vvp:)/, @args);
+            $plargs{$tname} = join(' ', @vvp_args);
         } else {
             $testtype{$tname} = $fields[1];
             $plargs{$tname} = "";
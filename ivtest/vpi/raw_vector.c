@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * This program tests the _vpiRawVectorVal format by copying the value
+ * of the first argument into each of the other arguments.
+ */
+# include  <vpi_user.h>
+# include  <assert.h>
+
+static PLI_INT32 my_raw_copy_calltf(PLI_BYTE8 *xx)
+{
+      s_vpi_value val;
+      p_vpi_raw_vector raw;
+
+      (void)xx;  /* Parameter is not used. */
+
+      vpiHandle sys = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, sys);
+
+      vpiHandle src = vpi_scan(argv);
+      vpiHandle arg;
+
+      val.format = _vpiRawVectorVal;
+      vpi_get_value(src, &val);
+      raw = (p_vpi_raw_vector)val.value.misc;
+      assert(raw->size == vpi_get(vpiSize, src));
+
+      while (0 != (arg = vpi_scan(argv))) {
+	    val.format = _vpiRawVectorVal;
+	    val.value.misc = (char*)raw;
+	    vpi_put_value(arg, &val, 0, vpiNoDelay);
+      }
+
+      return 0;
+}
+
+static void my_raw_copy_register(void)
+{
+      s_vpi_systf_data tf_data;
+
+      tf_data.type      = vpiSysTask;
+      tf_data.tfname    = "$my_raw_copy";
+      tf_data.calltf    = my_raw_copy_calltf;
+      tf_data.compiletf = 0;
+      tf_data.sizetf    = 0;
+      vpi_register_systf(&tf_data);
+}
+
+void (*vlog_startup_routines[])(void) = {
+      my_raw_copy_register,
+      0
+};
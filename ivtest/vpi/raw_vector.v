@@ -0,0 +1,19 @@
+module main;
+
+   reg [99:0] a, b;
+   reg [7:0] c;
+   reg [119:0] d;
+   wire [99:0] w = a;
+
+   initial begin
+      a = 100'hx_123_4567_89ab_cdef_z000_0000_5;
+      #1 $my_raw_copy(a, b, c, d);
+      $display("b=%b", b);
+      $display("c=%b", c);
+      $display("d=%b", d);
+      a = 100'h5_5555_5555_5555_5555_5555_5555;
+      #1 $my_raw_copy(w, b);
+      $display("b=%h", b);
+   end
+
+endmodule // main
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * This program tests the batched _cbValueRecord callbacks.
+ */
+# include  <vpi_user.h>
+# include  <assert.h>
+
+static PLI_INT32 record_cb(p_cb_data cb)
+{
+      p_vpi_value_record rec = (p_vpi_value_record)cb->value->value.misc;
+      PLI_INT32 idx;
+      int wdx;
+
+      assert(cb->reason == _cbValueRecord);
+      assert(cb->value->format == _vpiRecordVal);
+
+      vpi_printf("time %u: %d records\n", (unsigned)cb->time->low,
+		 (int)cb->index);
+      for (idx = 0 ; idx < cb->index ; idx += 1) {
+	    vpi_printf("  %s:", vpi_get_str(vpiName, rec[idx].obj));
+	    if (rec[idx].size == 0) {
+		  vpi_printf(" %f\n", rec[idx].value.real);
+		  continue;
+	    }
+	    for (wdx = (rec[idx].size+31)/32 ; wdx > 0 ; wdx -= 1) {
+		  vpi_printf(" %08x/%08x",
+			     (unsigned)rec[idx].value.vector[wdx-1].aval,
+			     (unsigned)rec[idx].value.vector[wdx-1].bval);
+	    }
+	    vpi_printf("\n");
+      }
+
+      return 0;
+}
+
+static PLI_INT32 my_record_calltf(PLI_BYTE8 *xx)
+{
+      struct t_cb_data cb;
+      struct t_vpi_time timerec;
+
+      (void)xx;  /* Parameter is not used. */
+
+      vpiHandle sys = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, sys);
+
+      vpiHandle arg;
+
+      timerec.type = vpiSimTime;
+      timerec.low = 0;
+      timerec.high = 0;
+
+      while (0 != (arg = vpi_scan(argv))) {
+	    cb.reason = _cbValueRecord;
+	    cb.cb_rtn = record_cb;
+	    cb.time = &timerec;
+	    cb.obj = arg;
+	    cb.value = 0;
+	    cb.user_data = 0;
+	    if (vpi_register_cb(&cb) == 0)
+		  vpi_printf("cannot record %s\n", vpi_get_str(vpiName, arg));
+      }
+
+      return 0;
+}
+
+static void my_record_register(void)
+{
+      s_vpi_systf_data tf_data;
+
+      tf_data.type      = vpiSysTask;
+      tf_data.tfname    = "$my_record";
+      tf_data.calltf    = my_record_calltf;
+      tf_data.compiletf = 0;
+      tf_data.sizetf    = 0;
+      vpi_register_systf(&tf_data);
+}
+
+void (*vlog_startup_routines[])(void) = {
+      my_record_register,
+      0
+};
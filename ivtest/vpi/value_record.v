@@ -0,0 +1,20 @@
+module main;
+
+   reg [7:0] a;
+   reg [39:0] b;
+   real r;
+   reg [3:0] mem [0:3];
+   event e;
+
+   initial begin
+      $my_record(a, b, r, mem[2], e);
+      #1 a = 8'h5a;
+         b = 40'hzx_1234_5678;
+         a = 8'h0f;
+      #1 r = 1.5;
+         mem[2] = 4'b10zx;
+      #1 mem[1] = 4'b0101;
+      #1 b = 40'h1;
+   end
+
+endmodule // main
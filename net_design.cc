@@ -397,15 +397,24 @@ NetScope* Design::find_scope(NetScope*scope, const hname_t&path,
 void Design::run_defparams()
 {
       for (list<NetScope*>::const_iterator scope = root_scopes_.begin();
-	   scope != root_scopes_.end(); ++ scope )
-	    (*scope)->run_defparams(this);
+	   scope != root_scopes_.end(); ++ scope ) {
+	    if ((*scope)->params_pending())
+		  (*scope)->run_defparams(this);
+      }
 }
 
+/*
+ * The defparams of a scope are collected when the scope is made, so
+ * only the scopes made since the last pass (which are marked as
+ * pending) can have any.
+ */
 void NetScope::run_defparams(Design*des)
 {
       for (map<hname_t,NetScope*>::const_iterator cur = children_.begin()
-		 ; cur != children_.end() ; ++ cur )
-	    cur->second->run_defparams(des);
+		 ; cur != children_.end() ; ++ cur ) {
+	    if (cur->second->params_pending_)
+		  cur->second->run_defparams(des);
+      }
 
       while (! defparams.empty()) {
 	    pair<pform_name_t,PExpr*> pp = defparams.front();
@@ -490,12 +499,14 @@ void Design::evaluate_parameters()
 {
       for (map<perm_string,NetScope*>::const_iterator cur = packages_.begin()
 		 ; cur != packages_.end() ; ++ cur) {
-	    cur->second->evaluate_parameters(this);
+	    if (cur->second->params_pending())
+		  cur->second->evaluate_parameters(this);
       }
 
       for (list<NetScope*>::const_iterator scope = root_scopes_.begin()
 		 ; scope != root_scopes_.end() ; ++ scope ) {
-	    (*scope)->evaluate_parameters(this);
+	    if ((*scope)->params_pending())
+		  (*scope)->evaluate_parameters(this);
       }
 }
 
@@ -900,21 +911,40 @@ void NetScope::evaluate_parameter_(Design*des, param_ref_t cur)
       cur->second.val_expr = 0;
 }
 
+/*
+ * This is run after each elaboration pass, but only goes down into
+ * the scopes that are marked as pending. A scope stays pending only
+ * while it or a scope below it has a parameter that is not evaluated,
+ * so that it is tried again in the next pass as before.
+ */
 void NetScope::evaluate_parameters(Design*des)
 {
       for (map<hname_t,NetScope*>::const_iterator cur = children_.begin()
-		 ; cur != children_.end() ; ++ cur )
-	    cur->second->evaluate_parameters(des);
+		 ; cur != children_.end() ; ++ cur ) {
+	    if (cur->second->params_pending_)
+		  cur->second->evaluate_parameters(des);
+      }
 
       if (debug_scopes)
 	    cerr << "debug: "
 		 << "Evaluating parameters in " << scope_path(this) << endl;
 
+      bool pending = false;
       for (param_ref_t cur = parameters.begin()
 		 ; cur != parameters.end() ;  ++ cur) {
 
             evaluate_parameter_(des, cur);
+	    if (cur->second.val == 0)
+		  pending = true;
       }
+
+      for (map<hname_t,NetScope*>::const_iterator cur = children_.begin()
+		 ; cur != children_.end() && ! pending ; ++ cur ) {
+	    if (cur->second->params_pending_)
+		  pending = true;
+      }
+
+      params_pending_ = pending;
 }
 
 void Design::residual_defparams()
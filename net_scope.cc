@@ -175,6 +175,19 @@ NetScope::NetScope(NetScope*up, const hname_t&n, NetScope::TYPE t, NetScope*in_u
       genvar_tmp_val = 0;
       tie_hi_ = 0;
       tie_lo_ = 0;
+      params_pending_ = false;
+      mark_params_pending_();
+}
+
+/*
+ * Mark this scope as needing the parameter passes, and mark the
+ * scopes above it so that the passes get down to it. A marked scope
+ * has marked parents, so the marking stops at the first one.
+ */
+void NetScope::mark_params_pending_()
+{
+      for (NetScope*cur = this ; cur && ! cur->params_pending_ ; cur = cur->up_)
+	    cur->params_pending_ = true;
 }
 
 NetScope::~NetScope()
@@ -321,6 +334,7 @@ void NetScope::set_parameter(perm_string key, bool is_annotatable,
       ref.val = 0;
       ref.ivl_type = 0;
       ref.set_line(file_line);
+      mark_params_pending_();
 }
 
 /*
@@ -340,6 +354,7 @@ void NetScope::set_parameter(perm_string key, NetExpr*val,
       ivl_assert(file_line, ref.ivl_type);
       ref.val = val;
       ref.set_line(file_line);
+      mark_params_pending_();
 }
 
 bool NetScope::auto_name(const char*prefix, char pad, const char* suffix)
@@ -413,6 +428,7 @@ void NetScope::replace_parameter(Design *des, perm_string key, PExpr*val, NetSco
 
       ref.val_expr = val;
       ref.val_scope = scope;
+      mark_params_pending_();
 }
 
 bool NetScope::make_parameter_unannotatable(perm_string key)
@@ -1161,6 +1161,7 @@ class NetScope : public Definitions, public Attrib {
       void run_defparams_later(class Design*);
 
       void evaluate_parameters(class Design*);
+      bool params_pending() const { return params_pending_; }
 
 	// Look for defparams that never matched, and print warnings.
       void residual_defparams(class Design*);
@@ -1255,6 +1256,7 @@ class NetScope : public Definitions, public Attrib {
       std::map<perm_string,LocalVar> loop_index_tmp;
 
     private:
+      void mark_params_pending_();
       void evaluate_parameter_logic_(Design*des, param_ref_t cur);
       void evaluate_parameter_real_(Design*des, param_ref_t cur);
       void evaluate_parameter_string_(Design*des, param_ref_t cur);
@@ -1310,6 +1312,11 @@ class NetScope : public Definitions, public Attrib {
       NetScope*up_;
       std::map<hname_t,NetScope*> children_;
 
+	// True if this scope or a scope below it may have defparams to
+	// run or parameters to evaluate. The parameter passes that run
+	// after each elaboration pass skip the subtrees that have none.
+      bool params_pending_;
+
       unsigned lcounter_;
       bool need_const_func_, is_const_func_, is_auto_, is_cell_, calls_stask_;
 
@@ -91,6 +91,42 @@ struct strobe_cb_info {
       vpiHandle*items;
       unsigned nitems;
       unsigned fd_mcd;
+      struct display_item*plan;
+};
+
+/*
+ * A constant format string is split once into runs of literal text
+ * and conversion specifications, so that a display that is called
+ * over and over does not parse the same format each time.
+ */
+struct format_spec {
+      const char*text; /* Literal text, or nil for a conversion. */
+      unsigned len;
+      int ljust, plus, ld_zero, width, prec;
+      char fmt;
+};
+
+struct format_plan {
+      char*str; /* The text of the specs points into this copy. */
+      struct format_spec*specs;
+      unsigned nspecs;
+};
+
+/*
+ * The display plan keeps the properties of each argument that do not
+ * change from call to call. The $display, $strobe and $monitor tasks
+ * make it once per call site, so that each call only has to get the
+ * values and format them. The other users of get_display() leave the
+ * plan nil, and the properties are then looked up as they are needed.
+ */
+struct display_item {
+      PLI_INT32 type;
+      PLI_INT32 const_type;
+      int is_real;
+      int has_size; /* The size of strings and such can change. */
+      PLI_INT32 size;
+      int dec_size;
+      struct format_plan*fmt; /* For a constant format string. */
 };
 
 /*
@@ -133,6 +169,55 @@ static int vpi_get_dec_size(vpiHandle item)
 	);
 }
 
+static int item_is_real(vpiHandle item, PLI_INT32 type)
+{
+      switch (type) {
+	  case vpiConstant:
+	  case vpiParameter:
+	    return vpi_get(vpiConstType, item) == vpiRealConst;
+	  case vpiRealVar:
+	    return 1;
+	  case vpiSysFuncCall:
+	    return vpi_get(vpiFuncType, item) == vpiRealFunc;
+	  default:
+	    return 0;
+      }
+}
+
+/* These get the properties of an argument from the plan if there is
+ * one, or else from the argument itself. */
+static PLI_INT32 info_item_type(const struct strobe_cb_info*info, unsigned idx)
+{
+      if (info->plan) return info->plan[idx].type;
+      return vpi_get(vpiType, info->items[idx]);
+}
+
+static PLI_INT32 info_item_const_type(const struct strobe_cb_info*info,
+                                      unsigned idx)
+{
+      if (info->plan) return info->plan[idx].const_type;
+      return vpi_get(vpiConstType, info->items[idx]);
+}
+
+static PLI_INT32 info_item_size(const struct strobe_cb_info*info, unsigned idx)
+{
+      if (info->plan && info->plan[idx].has_size) return info->plan[idx].size;
+      return vpi_get(vpiSize, info->items[idx]);
+}
+
+static int info_item_dec_size(const struct strobe_cb_info*info, unsigned idx)
+{
+      if (info->plan && info->plan[idx].has_size)
+	    return info->plan[idx].dec_size;
+      return vpi_get_dec_size(info->items[idx]);
+}
+
+static int info_item_is_real(const struct strobe_cb_info*info, unsigned idx)
+{
+      if (info->plan) return info->plan[idx].is_real;
+      return item_is_real(info->items[idx], vpi_get(vpiType, info->items[idx]));
+}
+
 static void array_from_iterator(struct strobe_cb_info*info, vpiHandle argv)
 {
       if (argv) {
@@ -488,7 +573,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
            * Icarus is 1 the string length will set the width of a real
            * displayed using %d. */
           if (width == -1) {
-            width = (ld_zero == 1) ? 0 : vpi_get_dec_size(info->items[*idx]);
+            width = (ld_zero == 1) ? 0 : info_item_dec_size(info, *idx);
           }
 
           /* If the default buffer is too small make it big enough. */
@@ -607,7 +692,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
             /* If all we have is a leading zero then we want a zero width. */
             if (ld_zero == 1) width = 0;
             /* Otherwise if a width was not given, use the value width. */
-            else width = (vpi_get(vpiSize, info->items[*idx])+7) / 8;
+            else width = (info_item_size(info, *idx)+7) / 8;
           }
           /* If the default buffer is too small make it big enough. */
           size = strlen(value.value.str) + 1;
@@ -627,14 +712,8 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
         vpi_printf("WARNING: %s:%d: missing argument for %s%s.\n",
                    info->filename, info->lineno, info->name, fmtb);
       } else {
-        PLI_INT32 type;
-
         /* Get the argument type and value. */
-        type = vpi_get(vpiType, info->items[*idx]);
-        if (((type == vpiConstant || type == vpiParameter) &&
-             vpi_get(vpiConstType, info->items[*idx]) == vpiRealConst) ||
-            type == vpiRealVar || (type == vpiSysFuncCall &&
-             vpi_get(vpiFuncType, info->items[*idx]) == vpiRealFunc)) {
+        if (info_item_is_real(info, *idx)) {
           value.format = vpiRealVal;
         } else {
           value.format = vpiDecStrVal;
@@ -750,7 +829,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           PLI_INT32 veclen, word, byte;
           char *cp;
 
-          veclen = (vpi_get(vpiSize, info->items[*idx])+31)/32;
+          veclen = (info_item_size(info, *idx)+31)/32;
           size = veclen * 4 + 1;
           /* If the default buffer is too small, make it big enough. */
           if (size > ini_size) result = realloc(result, size*sizeof(char));
@@ -797,7 +876,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
 
           /* If a width was not given use a width of zero. */
           if (width == -1) width = 0;
-          nbits = vpi_get(vpiSize, info->items[*idx]);
+          nbits = info_item_size(info, *idx);
           /* This is 4 chars for all but the last bit (strength + "_")
            * which only needs three chars (strength), but then you need
            * space for the EOS '\0', so it is just number of bits * 4. */
@@ -841,7 +920,7 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
           PLI_INT32 veclen, word, elem, bits, byte;
           char *cp;
 
-          veclen = (vpi_get(vpiSize, info->items[*idx])+31)/32;
+          veclen = (info_item_size(info, *idx)+31)/32;
           size = 2 * veclen * 4 + 1;
           /* If the default buffer is too small, make it big enough. */
           if (size > ini_size) result = realloc(result, size*sizeof(char));
@@ -882,59 +961,113 @@ static unsigned int get_format_char(char **rtn, int ljust, int plus,
   return size - 1;
 }
 
-/* We can't use the normal str functions on the return value since
- * %u and %z can insert NULL characters into the stream. */
-static unsigned int get_format(char **rtn, char *fmt,
-                               const struct strobe_cb_info *info, unsigned int *idx)
+/* Split a format string into literal text and conversion specs. */
+static struct format_plan *parse_format(const char *fmt)
 {
-  char *cp = fmt;
-  unsigned int size;
+  struct format_plan *plan = malloc(sizeof(struct format_plan));
+  char *cp;
 
-  *rtn = strdup("");
-  size = 1;
+  plan->str = strdup(fmt);
+  plan->specs = 0;
+  plan->nspecs = 0;
+  cp = plan->str;
   while (*cp) {
+    struct format_spec *spec;
     size_t cnt = strcspn(cp, "%");
 
+    plan->specs = realloc(plan->specs,
+                          (plan->nspecs+1)*sizeof(struct format_spec));
+    spec = plan->specs + plan->nspecs;
+    plan->nspecs += 1;
+
     if (cnt > 0) {
-      *rtn = realloc(*rtn, (size+cnt)*sizeof(char));
-      memcpy(*rtn+size-1, cp, cnt);
-      size += cnt;
+      spec->text = cp;
+      spec->len = cnt;
       cp += cnt;
     } else {
-      int ljust = 0, plus = 0, ld_zero = 0, width = -1, prec = -1;
-      char *result;
+      spec->text = 0;
+      spec->len = 0;
+      spec->ljust = 0;
+      spec->plus = 0;
+      spec->ld_zero = 0;
+      spec->width = -1;
+      spec->prec = -1;
 
       cp += 1;
       while ((*cp == '-') || (*cp == '+')) {
-        if (*cp == '-') ljust = 1;
-        else plus = 1;
+        if (*cp == '-') spec->ljust = 1;
+        else spec->plus = 1;
         cp += 1;
       }
       if (*cp == '0') {
-        ld_zero = 1;
+        spec->ld_zero = 1;
         cp += 1;
       }
-      if (isdigit((int)*cp)) width = strtoul(cp, &cp, 10);
+      if (isdigit((int)*cp)) spec->width = strtoul(cp, &cp, 10);
       if (*cp == '.') {
         cp += 1;
-        prec = strtoul(cp, &cp, 10);
+        spec->prec = strtoul(cp, &cp, 10);
       }
-      cnt = get_format_char(&result, ljust, plus, ld_zero, width, prec, *cp,
-                            info, idx);
+      spec->fmt = *cp;
+      if (*cp) cp += 1;
+    }
+  }
+  return plan;
+}
+
+static void free_format_plan(struct format_plan *plan)
+{
+  free(plan->specs);
+  free(plan->str);
+  free(plan);
+}
+
+/* We can't use the normal str functions on the return value since
+ * %u and %z can insert NULL characters into the stream. */
+static unsigned int run_format(char **rtn, const struct format_plan *plan,
+                               const struct strobe_cb_info *info,
+                               unsigned int *idx)
+{
+  unsigned int size, cnt, sdx;
+
+  *rtn = strdup("");
+  size = 1;
+  for (sdx = 0; sdx < plan->nspecs; sdx += 1) {
+    const struct format_spec *spec = plan->specs + sdx;
+
+    if (spec->text) {
+      cnt = spec->len;
+      *rtn = realloc(*rtn, (size+cnt)*sizeof(char));
+      memcpy(*rtn+size-1, spec->text, cnt);
+      size += cnt;
+    } else {
+      char *result;
+
+      cnt = get_format_char(&result, spec->ljust, spec->plus, spec->ld_zero,
+                            spec->width, spec->prec, spec->fmt, info, idx);
       *rtn = realloc(*rtn, (size+cnt)*sizeof(char));
       memcpy(*rtn+size-1, result, cnt);
       free(result);
       size += cnt;
-      if (*cp) cp += 1;
     }
   }
   *(*rtn+size-1) = '\0';
   return size - 1;
 }
 
+static unsigned int get_format(char **rtn, char *fmt,
+                               const struct strobe_cb_info *info, unsigned int *idx)
+{
+  struct format_plan *plan = parse_format(fmt);
+  unsigned int size = run_format(rtn, plan, info, idx);
+  free_format_plan(plan);
+  return size;
+}
+
 static unsigned int get_numeric(char **rtn, const struct strobe_cb_info *info,
-                                vpiHandle item)
+                                unsigned int idx)
 {
+  vpiHandle item = info->items[idx];
   int size, min;
   s_vpi_value val;
 
@@ -943,7 +1076,7 @@ static unsigned int get_numeric(char **rtn, const struct strobe_cb_info *info,
 
   switch(info->default_format){
     case vpiDecStrVal:
-      size = vpi_get_dec_size(item);
+      size = info_item_dec_size(info, idx);
 	/* -1 can be represented as a one bit signed value. This returns
 	 * a size of 1 which is too small for the -1 string value so make
 	 * the string width the minimum display width. */
@@ -974,17 +1107,19 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
   for  (idx = 0; idx < info->nitems; idx += 1) {
     vpiHandle item = info->items[idx];
 
-    switch (vpi_get(vpiType, item)) {
+    switch (info_item_type(info, idx)) {
 
       case vpiConstant:
       case vpiParameter:
-        if (vpi_get(vpiConstType, item) == vpiStringConst) {
+        if (info->plan && info->plan[idx].fmt) {
+          width = run_format(&result, info->plan[idx].fmt, info, &idx);
+        } else if (info_item_const_type(info, idx) == vpiStringConst) {
           value.format = vpiStringVal;
           vpi_get_value(item, &value);
           fmt = strdup(value.value.str);
           width = get_format(&result, fmt, info, &idx);
           free(fmt);
-        } else if (vpi_get(vpiConstType, item) == vpiRealConst) {
+        } else if (info_item_const_type(info, idx) == vpiRealConst) {
           value.format = vpiRealVal;
           vpi_get_value(item, &value);
 #if !defined(__GNUC__)
@@ -1002,7 +1137,7 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
           result = strdup(buf);
           width = strlen(result);
         } else {
-          width = get_numeric(&result, info, item);
+          width = get_numeric(&result, info, idx);
         }
         rtn = realloc(rtn, (size+width)*sizeof(char));
         memcpy(rtn+size-1, result, width);
@@ -1019,7 +1154,7 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
       case vpiIntegerVar:
       case vpiMemoryWord:
       case vpiPartSelect:
-        width = get_numeric(&result, info, item);
+        width = get_numeric(&result, info, idx);
         rtn = realloc(rtn, (size+width)*sizeof(char));
         memcpy(rtn+size-1, result, width);
         free(result);
@@ -1138,6 +1273,69 @@ static char *get_display(unsigned int *rtnsz, const struct strobe_cb_info *info)
   return rtn;
 }
 
+static void make_display_plan(struct strobe_cb_info *info)
+{
+      unsigned idx;
+
+      info->plan = calloc(info->nitems, sizeof(struct display_item));
+      for (idx = 0 ;  idx < info->nitems ;  idx += 1) {
+	    vpiHandle item = info->items[idx];
+	    struct display_item *cur = info->plan + idx;
+
+	    cur->type = vpi_get(vpiType, item);
+	    cur->const_type = vpiUndefined;
+	    cur->is_real = item_is_real(item, cur->type);
+	    cur->has_size = 0;
+	    cur->fmt = 0;
+
+	    switch (cur->type) {
+		case vpiConstant:
+		case vpiParameter:
+		    /* A string that is the result of an expression is
+		       passed as a constant, but it changes from call
+		       to call like a variable. */
+		  cur->const_type = vpi_get(vpiConstType, item);
+		  if (vpi_get(_vpiFromThr, item) == _vpiString) break;
+		  if (cur->const_type == vpiStringConst) {
+			s_vpi_value value;
+			value.format = vpiStringVal;
+			vpi_get_value(item, &value);
+			cur->fmt = parse_format(value.value.str);
+		  }
+		  // fallthrough
+		case vpiNet:
+		case vpiReg:
+		case vpiBitVar:
+		case vpiByteVar:
+		case vpiShortIntVar:
+		case vpiIntVar:
+		case vpiLongIntVar:
+		case vpiIntegerVar:
+		case vpiMemoryWord:
+		case vpiPartSelect:
+		  cur->has_size = 1;
+		  cur->size = vpi_get(vpiSize, item);
+		  cur->dec_size = calc_dec_size(cur->size,
+		                                vpi_get(vpiSigned, item) == 1);
+		  break;
+		default:
+		  break;
+	    }
+      }
+}
+
+static void free_display_plan(struct strobe_cb_info *info)
+{
+      unsigned idx;
+
+      if (info->plan == 0) return;
+      for (idx = 0 ;  idx < info->nitems ;  idx += 1) {
+	    if (info->plan[idx].fmt) free_format_plan(info->plan[idx].fmt);
+      }
+      free(info->plan);
+      info->plan = 0;
+}
+
 #ifdef BR916_STOPGAP_FIX
 static char br916_hint_issued = 0;
 #endif
@@ -1276,27 +1474,68 @@ static PLI_INT32 sys_display_compiletf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return sys_common_compiletf(name, 0, 0);
 }
 
+/*
+ * The $display like tasks keep the argument list and the display plan
+ * for each call site in the user data of the call. The file descriptor
+ * argument is kept apart, as its value is needed before formatting.
+ */
+struct display_call {
+      vpiHandle fd;
+      struct strobe_cb_info info;
+	/* All the calls are listed so they can be freed at the end. */
+      struct display_call *next;
+};
+
+static struct display_call *display_calls = 0;
+
+static struct display_call *get_display_call(vpiHandle callh,
+                                             const char *name)
+{
+      struct display_call *call = vpi_get_userdata(callh);
+      vpiHandle argv, scope;
+
+      if (call) return call;
+
+      argv = vpi_iterate(vpiArgument, callh);
+      scope = vpi_handle(vpiScope, callh);
+      assert(scope);
+
+      call = calloc(1, sizeof(struct display_call));
+      if (name[1] == 'f') call->fd = vpi_scan(argv);
+	/* We could use vpi_get_str(vpiName, callh) to get the task name,
+	 * but name is already defined. */
+      call->info.name = name;
+      call->info.filename = strdup(vpi_get_str(vpiFile, callh));
+      call->info.lineno = (int)vpi_get(vpiLineNo, callh);
+      call->info.default_format = get_default_format(name);
+      call->info.scope = scope;
+      array_from_iterator(&call->info, argv);
+      make_display_plan(&call->info);
+      call->next = display_calls;
+      display_calls = call;
+
+      vpi_put_userdata(callh, call);
+      return call;
+}
+
 /* This implements the $sformatf, $display/$fdisplay
  * and the $write/$fwrite based tasks. */
 static PLI_INT32 sys_display_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 {
-      vpiHandle callh, argv, scope;
-      struct strobe_cb_info info;
+      vpiHandle callh;
+      struct display_call *call;
       char* result;
       unsigned int size;
       PLI_UINT32 fd_mcd;
       s_vpi_value val;
 
       callh = vpi_handle(vpiSysTfCall, 0);
-      argv = vpi_iterate(vpiArgument, callh);
+      call = get_display_call(callh, name);
 
 	/* Get the file/MC descriptor and verify it is valid. */
       if (name[1] == 'f') {
-	    vpiHandle fd = vpi_scan(argv);
-	    if (get_fd_mcd_from_arg(&fd_mcd, fd, callh, name)) {
-		  vpi_free_object(argv);
+	    if (get_fd_mcd_from_arg(&fd_mcd, call->fd, callh, name))
 		  return 0;
-	    }
       } else if (strncmp(name, "$sformatf", 9) == 0) {
 	      /* return as a string */
 	    fd_mcd = 0;
@@ -1305,20 +1544,9 @@ static PLI_INT32 sys_display_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 	    fd_mcd = 1;
       }
 
-      scope = vpi_handle(vpiScope, callh);
-      assert(scope);
-	/* We could use vpi_get_str(vpiName, callh) to get the task name,
-	 * but name is already defined. */
-      info.name = name;
-      info.filename = strdup(vpi_get_str(vpiFile, callh));
-      info.lineno = (int)vpi_get(vpiLineNo, callh);
-      info.default_format = get_default_format(name);
-      info.scope = scope;
-      array_from_iterator(&info, argv);
-
 	/* Because %u and %z may put embedded NULL characters into the
 	 * returned string strlen() may not match the real size! */
-      result = get_display(&size, &info);
+      result = get_display(&size, &call->info);
 
       if (fd_mcd > 0) {
 	     my_mcd_rawwrite(fd_mcd, result, size);
@@ -1332,8 +1560,6 @@ static PLI_INT32 sys_display_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       }
 
       free(result);
-      free(info.filename);
-      free(info.items);
       return 0;
 }
 
@@ -1362,8 +1588,8 @@ static PLI_INT32 strobe_cb(p_cb_data cb)
 	    free(result);
       }
 
-      free(info->filename);
-      free(info->items);
+	/* This is a copy of the information kept with the call, with
+	 * the descriptor of this call, so only the copy is freed. */
       free(info);
       return 0;
 }
@@ -1378,40 +1604,28 @@ static PLI_INT32 sys_strobe_compiletf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 /* This implements both the $strobe and $fstrobe based tasks. */
 static PLI_INT32 sys_strobe_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
-      vpiHandle callh, argv, scope;
+      vpiHandle callh;
+      struct display_call *call;
       struct t_cb_data cb;
       struct t_vpi_time timerec;
       struct strobe_cb_info*info;
       PLI_UINT32 fd_mcd;
 
       callh = vpi_handle(vpiSysTfCall, 0);
-      argv = vpi_iterate(vpiArgument, callh);
+      call = get_display_call(callh, name);
 
 	/* Get the file/MC descriptor and verify it is valid. */
       if (name[1] == 'f') {
-	    vpiHandle fd = vpi_scan(argv);
-	    if (get_fd_mcd_from_arg(&fd_mcd, fd, callh, name)) {
-		  vpi_free_object(argv);
+	    if (get_fd_mcd_from_arg(&fd_mcd, call->fd, callh, name))
                   return 0;
-	    }
 
       } else {
 	    fd_mcd = 1;
       }
 
-      scope = vpi_handle(vpiScope, callh);
-      assert(scope);
-
-      info = calloc(1, sizeof(struct strobe_cb_info));
+      info = malloc(sizeof(struct strobe_cb_info));
+      *info = call->info;
       info->fd_mcd = fd_mcd;
-	/* We could use vpi_get_str(vpiName, callh) to get the task name,
-	 * but name is already defined. */
-      info->name = name;
-      info->filename = strdup(vpi_get_str(vpiFile, callh));
-      info->lineno = (int)vpi_get(vpiLineNo, callh);
-      info->default_format = get_default_format(name);
-      info->scope= scope;
-      array_from_iterator(info, argv);
 
       timerec.type = vpiSimTime;
       timerec.low = 0;
@@ -1436,7 +1650,7 @@ static PLI_INT32 sys_strobe_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
  * though that monitor may be watching many variables).
  */
 
-static struct strobe_cb_info monitor_info = { 0, 0, 0, 0, 0, 0, 0, 0 };
+static struct strobe_cb_info monitor_info = { 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 static vpiHandle *monitor_callbacks = 0;
 static int monitor_scheduled = 0;
 static int monitor_enabled = 1;
@@ -1527,6 +1741,7 @@ static PLI_INT32 sys_monitor_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 	    free(monitor_callbacks);
 	    monitor_callbacks = 0;
 
+	    free_display_plan(&monitor_info);
 	    free(monitor_info.filename);
 	    free(monitor_info.items);
 	    monitor_info.items = 0;
@@ -1544,6 +1759,7 @@ static PLI_INT32 sys_monitor_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       monitor_info.default_format = get_default_format(name);
       monitor_info.scope = scope;
       monitor_info.fd_mcd = 1;
+      make_display_plan(&monitor_info);
 
 	/* Attach callbacks to all the parameters that might change. */
       monitor_callbacks = calloc(monitor_info.nitems, sizeof(vpiHandle));
@@ -1662,6 +1878,7 @@ static PLI_INT32 sys_swrite_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
   info.lineno = (int)vpi_get(vpiLineNo, callh);
   info.default_format = get_default_format(name);
   info.scope = scope;
+  info.plan = 0;
   array_from_iterator(&info, argv);
 
   /* Because %u and %z may put embedded NULL characters into the returned
@@ -1763,6 +1980,7 @@ static PLI_INT32 sys_sformat_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
   info.lineno = (int)vpi_get(vpiLineNo, callh);
   info.default_format = get_default_format(name);
   info.scope = scope;
+  info.plan = 0;
   array_from_iterator(&info, argv);
   idx = -1;
   size = get_format(&result, fmt, &info, &idx);
@@ -2140,6 +2358,7 @@ static PLI_INT32 sys_severity_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       info.lineno = (int)vpi_get(vpiLineNo, callh);
       info.default_format = vpiDecStrVal;
       info.scope = scope;
+      info.plan = 0;
       array_from_iterator(&info, argv);
 
       vpi_printf("%s: %s:%d: ", sstr, info.filename, info.lineno);
@@ -2168,6 +2387,10 @@ static PLI_INT32 sys_severity_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       free(info.items);
       free(dstr);
 
+	/* Keep the waves that lead up to the failure. */
+      if (strncmp(name,"$fatal",6) == 0 || strncmp(name,"$error",6) == 0)
+	    sys_flight_trigger(name);
+
       if (strncmp(name,"$fatal",6) == 0) {
 	      /* Set the exit code from vvp as an error code. */
 	    vpip_set_return_value(1);
@@ -2184,12 +2407,22 @@ static PLI_INT32 sys_end_of_simulation(p_cb_data cb_data)
       (void)cb_data; /* Parameter is not used. */
       free(monitor_callbacks);
       monitor_callbacks = 0;
+      free_display_plan(&monitor_info);
       free(monitor_info.filename);
       free(monitor_info.items);
       monitor_info.items = 0;
       monitor_info.nitems = 0;
       monitor_info.name = 0;
 
+      while (display_calls) {
+	    struct display_call *call = display_calls;
+	    display_calls = call->next;
+	    free_display_plan(&call->info);
+	    free(call->info.filename);
+	    free(call->info.items);
+	    free(call);
+      }
+
       free(timeformat_info.suff);
       timeformat_info.suff = 0;
       return 0;
@@ -88,6 +88,7 @@ static PLI_INT32 sys_finish_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       }
 
       if (strcmp((const char*)name, "$stop") == 0) {
+	    sys_flight_trigger("$stop");
 	    vpi_control(vpiStop, diag_msg);
 	    return 0;
       }
@@ -0,0 +1,949 @@
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include "sys_priv.h"
+# include "vcd_priv.h"
+#ifdef HAVE_LIBZ
+# include "fstapi.h"
+#endif
+
+/*
+ * This file contains the flight recorder. $flightrecorder keeps the
+ * recent value changes of the selected signals in a memory ring of a
+ * fixed size, and $flightdump writes them out as a VCD or FST file.
+ * A $error, $fatal or $stop also writes them out, so a run that
+ * passes never touches the disk.
+ *
+ *    $flightrecorder(depth, scope or signal...);
+ *    $flightdump[(file name)];
+ *
+ * The depth is in the time units of the caller, and zero keeps as
+ * much as the byte budget allows. Like $dumpvars, the whole design is
+ * recorded if no scopes are given.
+ *
+ * The ring holds a group for each time step with changes. A group is
+ * a header of FLIGHT_HDR words (the group length in words and the
+ * time) followed by an entry for each changed signal: the signal
+ * index and the value, either the s_vpi_vecval words of a vector or
+ * the bits of a double. When a group is older than the depth, or its
+ * space is needed, it is folded into the base values, which are the
+ * values at the start of the recorded window.
+ */
+
+# include  <ctype.h>
+# include  <limits.h>
+# include  <stdio.h>
+# include  <stdlib.h>
+# include  <string.h>
+# include  <assert.h>
+# include  <time.h>
+# include  "ivl_alloc.h"
+
+# define FLIGHT_HDR 3
+
+struct flight_sig {
+      vpiHandle item;
+	/* The vector width, or 0 for a real value. */
+      PLI_INT32 size;
+	/* The number of words of the value in the ring. */
+      unsigned words;
+	/* The value at the start of the window, and the value while
+	 * the window is replayed by a dump. */
+      PLI_UINT32 *base;
+      PLI_UINT32 *cur;
+      char ident[8];
+};
+
+/*
+ * The declarations of the dump are kept as a list of these, so that
+ * they can be written out each time the recorder is dumped.
+ */
+enum flight_hdr_kind { FLIGHT_SCOPE, FLIGHT_VAR, FLIGHT_UPSCOPE };
+
+struct flight_hdr {
+      enum flight_hdr_kind kind;
+      const char *type;
+	/* The scope name, or the variable name with its range. */
+      char *name;
+      unsigned sig;
+};
+
+static struct flight_sig *flight_sigs = 0;
+static unsigned flight_nsigs = 0;
+static struct flight_hdr *flight_hdrs = 0;
+static unsigned flight_nhdrs = 0;
+
+static int flight_active = 0;
+static PLI_UINT64 flight_depth = 0;
+static PLI_UINT64 base_time = 0;
+
+/* The extended arguments can change the file and the byte budget. */
+static char *flight_path = 0;
+static size_t flight_budget = 16*1024*1024;
+
+static PLI_UINT32 *ring = 0;
+static size_t ring_cap = 0;
+static size_t ring_head = 0;
+static size_t ring_tail = 0;
+static size_t ring_wrap = 0;
+static int ring_wrapped = 0;
+static unsigned ring_groups = 0;
+
+static const char*units_names[] = {
+      "s",
+      "ms",
+      "us",
+      "ns",
+      "ps",
+      "fs"
+};
+
+static char flightid[8] = "!";
+
+static void gen_new_flight_id(void)
+{
+      static unsigned value = 0;
+      unsigned v = ++value;
+      unsigned int i;
+
+      for (i=0; i < sizeof(flightid)-1; i++) {
+           flightid[i] = (char)((v%94)+33); /* for range 33..126 */
+           v /= 94;
+           if(!v) {
+                 flightid[i+1] = '\0';
+                 return;
+           }
+      }
+      assert(0);
+}
+
+static PLI_UINT64 group_time(const PLI_UINT32*grp)
+{
+      PLI_UINT64 res = grp[2];
+      res <<= 32;
+      res |= grp[1];
+      return res;
+}
+
+static void store_vector(PLI_UINT32*dst, const struct flight_sig*sig,
+                         p_vpi_vecval vec)
+{
+      unsigned idx;
+      for (idx = 0 ; idx < sig->words/2 ; idx += 1) {
+	    dst[2*idx+0] = vec[idx].aval;
+	    dst[2*idx+1] = vec[idx].bval;
+      }
+}
+
+static void store_record(PLI_UINT32*dst, const struct flight_sig*sig,
+                         const s_vpi_value_record*rec)
+{
+      if (sig->size == 0) memcpy(dst, &rec->value.real, sizeof(double));
+      else store_vector(dst, sig, rec->value.vector);
+}
+
+/* Get the present value of the signal in the ring form. */
+static void get_current(PLI_UINT32*dst, const struct flight_sig*sig)
+{
+      s_vpi_value value;
+
+      if (sig->size == 0) {
+	    value.format = vpiRealVal;
+	    vpi_get_value(sig->item, &value);
+	    memcpy(dst, &value.value.real, sizeof(double));
+      } else {
+	    value.format = vpiVectorVal;
+	    vpi_get_value(sig->item, &value);
+	    store_vector(dst, sig, value.value.vector);
+      }
+}
+
+/*
+ * Drop the oldest group from the ring, and move its values into the
+ * base values.
+ */
+static void ring_evict(void)
+{
+      PLI_UINT32*grp = ring + ring_head;
+      PLI_UINT32*cp = grp + FLIGHT_HDR;
+      PLI_UINT32*end = grp + grp[0];
+
+      assert(ring_groups > 0);
+      while (cp < end) {
+	    struct flight_sig*sig = flight_sigs + cp[0];
+	    memcpy(sig->base, cp+1, sig->words*sizeof(PLI_UINT32));
+	    cp += 1 + sig->words;
+      }
+      base_time = group_time(grp);
+
+      ring_head += grp[0];
+      ring_groups -= 1;
+      if (ring_wrapped && ring_head == ring_wrap) {
+	    ring_head = 0;
+	    ring_wrapped = 0;
+      }
+      if (ring_groups == 0) {
+	    ring_head = 0;
+	    ring_tail = 0;
+	    ring_wrapped = 0;
+      }
+}
+
+/*
+ * Make room for a group of the given size at the end of the ring,
+ * dropping old groups as needed. A group is never split, so if it
+ * does not fit at the end it goes at the start. Return 0 if the
+ * group is larger than the whole ring.
+ */
+static PLI_UINT32* ring_alloc(size_t need)
+{
+      PLI_UINT32*res;
+
+      if (need > ring_cap) {
+	    while (ring_groups > 0) ring_evict();
+	    return 0;
+      }
+
+      for (;;) {
+	    if (ring_wrapped) {
+		  if (ring_head - ring_tail >= need) break;
+	    } else {
+		  if (ring_cap - ring_tail >= need) break;
+		  if (ring_head >= need) {
+			ring_wrap = ring_tail;
+			ring_tail = 0;
+			ring_wrapped = 1;
+			break;
+		  }
+	    }
+	    ring_evict();
+      }
+
+      res = ring + ring_tail;
+      ring_tail += need;
+      ring_groups += 1;
+      return res;
+}
+
+/*
+ * The run time calls this at the end of each time step with all the
+ * recorded signals that changed in the step.
+ */
+static PLI_INT32 flight_record_cb(p_cb_data cause)
+{
+      p_vpi_value_record rec = (p_vpi_value_record)cause->value->value.misc;
+      PLI_UINT64 now = timerec_to_time64(cause->time);
+      size_t need = FLIGHT_HDR;
+      PLI_UINT32*grp, *cp;
+      PLI_INT32 idx;
+
+      if (!flight_active) return 0;
+
+      for (idx = 0 ; idx < cause->index ; idx += 1) {
+	    struct flight_sig*sig = flight_sigs + (intptr_t)rec[idx].user_data;
+	    need += 1 + sig->words;
+      }
+
+	/* Fold the steps that are now outside the window. */
+      while (flight_depth > 0 && ring_groups > 0 &&
+             group_time(ring + ring_head) + flight_depth < now) {
+	    ring_evict();
+      }
+
+      grp = ring_alloc(need);
+      if (grp == 0) {
+	      /* This step alone does not fit, so only keep the values. */
+	    for (idx = 0 ; idx < cause->index ; idx += 1) {
+		  struct flight_sig*sig = flight_sigs + (intptr_t)rec[idx].user_data;
+		  store_record(sig->base, sig, rec + idx);
+	    }
+	    base_time = now;
+	    return 0;
+      }
+
+      grp[0] = need;
+      grp[1] = (PLI_UINT32)now;
+      grp[2] = (PLI_UINT32)(now >> 32);
+      cp = grp + FLIGHT_HDR;
+      for (idx = 0 ; idx < cause->index ; idx += 1) {
+	    struct flight_sig*sig = flight_sigs + (intptr_t)rec[idx].user_data;
+	    cp[0] = sig - flight_sigs;
+	    store_record(cp+1, sig, rec + idx);
+	    cp += 1 + sig->words;
+      }
+      assert(cp == grp + need);
+
+      return 0;
+}
+
+static void add_hdr(enum flight_hdr_kind kind, const char*type,
+                    char*name, unsigned sig)
+{
+      flight_hdrs = realloc(flight_hdrs,
+                            (flight_nhdrs+1)*sizeof(struct flight_hdr));
+      flight_hdrs[flight_nhdrs].kind = kind;
+      flight_hdrs[flight_nhdrs].type = type;
+      flight_hdrs[flight_nhdrs].name = name;
+      flight_hdrs[flight_nhdrs].sig  = sig;
+      flight_nhdrs += 1;
+}
+
+static void add_var(vpiHandle item, const char*type)
+{
+      struct t_cb_data cb;
+      struct t_vpi_time time;
+      struct flight_sig*sig;
+      const char*name = vpi_get_str(vpiName, item);
+      const char*prefix = is_escaped_id(name) ? "\\" : "";
+      PLI_INT32 size = vpi_get(vpiSize, item);
+      char*buf;
+
+      flight_sigs = realloc(flight_sigs,
+                            (flight_nsigs+1)*sizeof(struct flight_sig));
+      sig = flight_sigs + flight_nsigs;
+      sig->item = item;
+      if (vpi_get(vpiType, item) == vpiRealVar) {
+	    sig->size = 0;
+	    sig->words = sizeof(double) / sizeof(PLI_UINT32);
+      } else {
+	    sig->size = size;
+	    sig->words = 2 * ((size + 31) / 32);
+      }
+      strcpy(sig->ident, flightid);
+      gen_new_flight_id();
+
+	/* The table may still move, so the user data is the index. */
+      time.type    = vpiSimTime;
+      cb.time      = &time;
+      cb.user_data = (char*)(intptr_t)flight_nsigs;
+      cb.value     = NULL;
+      cb.obj       = item;
+      cb.reason    = _cbValueRecord;
+      cb.cb_rtn    = flight_record_cb;
+      if (vpi_register_cb(&cb) == 0) {
+	    vpi_printf("Flight recorder warning: cannot record %s.\n",
+	               vpi_get_str(vpiFullName, item));
+	    return;
+      }
+
+      buf = malloc(strlen(prefix) + strlen(name) + 32);
+      if (size > 1 || vpi_get(vpiLeftRange, item) != 0) {
+	    sprintf(buf, "%s%s [%i:%i]", prefix, name,
+	            (int)vpi_get(vpiLeftRange, item),
+	            (int)vpi_get(vpiRightRange, item));
+      } else {
+	    sprintf(buf, "%s%s", prefix, name);
+      }
+      add_hdr(FLIGHT_VAR, type, buf, flight_nsigs);
+
+      sig->base = malloc(sig->words*sizeof(PLI_UINT32));
+      sig->cur  = malloc(sig->words*sizeof(PLI_UINT32));
+      get_current(sig->base, sig);
+      flight_nsigs += 1;
+}
+
+static const char* scope_type(vpiHandle item)
+{
+      switch (vpi_get(vpiType, item)) {
+	  case vpiNamedBegin: return "begin";
+	  case vpiGenScope:   return "begin";
+	  case vpiNamedFork:  return "fork";
+	  case vpiFunction:   return "function";
+	  case vpiModule:     return "module";
+	  case vpiTask:       return "task";
+	  default:            return 0;
+      }
+}
+
+static void scan_item(vpiHandle item)
+{
+      PLI_INT32 item_type = vpi_get(vpiType, item);
+      const char*type;
+
+      switch (item_type) {
+	  case vpiIntVar:
+	  case vpiIntegerVar: type = "integer"; break;
+	  case vpiRealVar:    type = "real"; break;
+	  case vpiBitVar:
+	  case vpiByteVar:
+	  case vpiShortIntVar:
+	  case vpiLongIntVar:
+	  case vpiReg:        type = "reg"; break;
+	  case vpiTimeVar:    type = "time"; break;
+	  case vpiNet:
+	    switch (vpi_get(vpiNetType, item)) {
+		case vpiWand:    type = "wand"; break;
+		case vpiWor:     type = "wor"; break;
+		case vpiTri:     type = "tri"; break;
+		case vpiTri0:    type = "tri0"; break;
+		case vpiTri1:    type = "tri1"; break;
+		case vpiTriReg:  type = "trireg"; break;
+		case vpiTriAnd:  type = "triand"; break;
+		case vpiTriOr:   type = "trior"; break;
+		case vpiSupply1: type = "supply1"; break;
+		case vpiSupply0: type = "supply0"; break;
+		default:         type = "wire"; break;
+	    }
+	    break;
+
+	  default:
+	    type = scope_type(item);
+	    if (type == 0) {
+		  vpi_printf("Flight recorder warning: cannot record a %s "
+		             "(%s).\n", vpi_get_str(vpiType, item),
+		             vpi_get_str(vpiFullName, item));
+		  return;
+	    }
+	    break;
+      }
+
+      if (scope_type(item) == 0) {
+	    if (vpi_get(vpiAutomatic, item)) return;
+	    add_var(item, type);
+
+      } else {
+	    static int types[] = {
+		  vpiNet,
+		  vpiReg,
+		  vpiVariables,
+		  vpiFunction,
+		  vpiGenScope,
+		  vpiModule,
+		  vpiNamedBegin,
+		  vpiNamedFork,
+		  vpiTask,
+		  -1
+	    };
+	    int i;
+
+	    add_hdr(FLIGHT_SCOPE, type, strdup(vpi_get_str(vpiName, item)), 0);
+	    for (i = 0 ; types[i] > 0 ; i += 1) {
+		  vpiHandle hand;
+		  vpiHandle argv = vpi_iterate(types[i], item);
+		  while (argv && (hand = vpi_scan(argv))) scan_item(hand);
+	    }
+	    add_hdr(FLIGHT_UPSCOPE, 0, 0, 0);
+      }
+}
+
+/* Declare the scopes that hold the item, and return how many. */
+static unsigned draw_scope(vpiHandle item)
+{
+      unsigned depth;
+      vpiHandle scope = vpi_handle(vpiScope, item);
+      if (!scope) return 0;
+
+      depth = 1 + draw_scope(scope);
+      add_hdr(FLIGHT_SCOPE, scope_type(scope),
+              strdup(vpi_get_str(vpiName, scope)), 0);
+      return depth;
+}
+
+/*
+ * The dump can go to a VCD file or, if the file name ends in .fst and
+ * FST is available, to an FST file. These write one part of the dump
+ * to whichever is open.
+ */
+static FILE*out_vcd = 0;
+#ifdef HAVE_LIBZ
+static void*out_fst = 0;
+static fstHandle*out_handles = 0;
+
+static enum fstScopeType fst_scope_type(const char*type)
+{
+      if (strcmp(type, "begin") == 0) return FST_ST_VCD_BEGIN;
+      if (strcmp(type, "fork") == 0) return FST_ST_VCD_FORK;
+      if (strcmp(type, "function") == 0) return FST_ST_VCD_FUNCTION;
+      if (strcmp(type, "task") == 0) return FST_ST_VCD_TASK;
+      return FST_ST_VCD_MODULE;
+}
+
+static enum fstVarType fst_var_type(const char*type)
+{
+      static const struct {
+	    const char*name;
+	    enum fstVarType type;
+      } map[] = {
+	    { "integer", FST_VT_VCD_INTEGER },
+	    { "real",    FST_VT_VCD_REAL },
+	    { "reg",     FST_VT_VCD_REG },
+	    { "time",    FST_VT_VCD_TIME },
+	    { "wand",    FST_VT_VCD_WAND },
+	    { "wor",     FST_VT_VCD_WOR },
+	    { "tri",     FST_VT_VCD_TRI },
+	    { "tri0",    FST_VT_VCD_TRI0 },
+	    { "tri1",    FST_VT_VCD_TRI1 },
+	    { "trireg",  FST_VT_VCD_TRIREG },
+	    { "triand",  FST_VT_VCD_TRIAND },
+	    { "trior",   FST_VT_VCD_TRIOR },
+	    { "supply1", FST_VT_VCD_SUPPLY1 },
+	    { "supply0", FST_VT_VCD_SUPPLY0 },
+	    { 0,         FST_VT_VCD_WIRE }
+      };
+      unsigned idx;
+      for (idx = 0 ; map[idx].name ; idx += 1)
+	    if (strcmp(type, map[idx].name) == 0) break;
+      return map[idx].type;
+}
+#endif
+
+static void out_header(const char*why)
+{
+      int prec = vpi_get(vpiTimePrecision, 0);
+      unsigned scale = 1;
+      unsigned udx = 0;
+      time_t walltime;
+      unsigned idx;
+
+      time(&walltime);
+
+      assert(prec >= -15);
+      while (prec < 0) {
+	    udx += 1;
+	    prec += 3;
+      }
+      while (prec > 0) {
+	    scale *= 10;
+	    prec -= 1;
+      }
+
+#ifdef HAVE_LIBZ
+      if (out_fst) {
+	    char scale_buf[65];
+	    fstWriterSetDate(out_fst, asctime(localtime(&walltime)));
+	    fstWriterSetVersion(out_fst, "Icarus Verilog");
+	    sprintf(scale_buf, "\t%u%s\n", scale, units_names[udx]);
+	    fstWriterSetTimescaleFromString(out_fst, scale_buf);
+	    fstWriterSetComment(out_fst, why);
+
+	    out_handles = calloc(flight_nsigs, sizeof(fstHandle));
+	    for (idx = 0 ; idx < flight_nhdrs ; idx += 1) {
+		  struct flight_hdr*hdr = flight_hdrs + idx;
+		  struct flight_sig*sig = flight_sigs + hdr->sig;
+		  switch (hdr->kind) {
+		      case FLIGHT_SCOPE:
+			fstWriterSetScope(out_fst, fst_scope_type(hdr->type),
+			                  hdr->name, 0);
+			break;
+		      case FLIGHT_VAR:
+			out_handles[hdr->sig] = fstWriterCreateVar(out_fst,
+			      fst_var_type(hdr->type), FST_VD_IMPLICIT,
+			      sig->size ? (uint32_t)sig->size : 64,
+			      hdr->name, 0);
+			break;
+		      case FLIGHT_UPSCOPE:
+			fstWriterSetUpscope(out_fst);
+			break;
+		  }
+	    }
+	    return;
+      }
+#endif
+
+      fprintf(out_vcd, "$date\n");
+      fprintf(out_vcd, "\t%s", asctime(localtime(&walltime)));
+      fprintf(out_vcd, "$end\n");
+      fprintf(out_vcd, "$version\n");
+      fprintf(out_vcd, "\tIcarus Verilog\n");
+      fprintf(out_vcd, "$end\n");
+      fprintf(out_vcd, "$comment\n");
+      fprintf(out_vcd, "\t%s\n", why);
+      fprintf(out_vcd, "$end\n");
+      fprintf(out_vcd, "$timescale\n");
+      fprintf(out_vcd, "\t%u%s\n", scale, units_names[udx]);
+      fprintf(out_vcd, "$end\n");
+
+      for (idx = 0 ; idx < flight_nhdrs ; idx += 1) {
+	    struct flight_hdr*hdr = flight_hdrs + idx;
+	    struct flight_sig*sig = flight_sigs + hdr->sig;
+	    switch (hdr->kind) {
+		case FLIGHT_SCOPE:
+		  fprintf(out_vcd, "$scope %s %s $end\n", hdr->type, hdr->name);
+		  break;
+		case FLIGHT_VAR:
+		  fprintf(out_vcd, "$var %s %u %s %s $end\n", hdr->type,
+		          sig->size ? (unsigned)sig->size : 64u,
+		          sig->ident, hdr->name);
+		  break;
+		case FLIGHT_UPSCOPE:
+		  fprintf(out_vcd, "$upscope $end\n");
+		  break;
+	    }
+      }
+      fprintf(out_vcd, "$enddefinitions $end\n");
+}
+
+static void out_time(PLI_UINT64 now)
+{
+#ifdef HAVE_LIBZ
+      if (out_fst) {
+	    fstWriterEmitTimeChange(out_fst, now);
+	    return;
+      }
+#endif
+      fprintf(out_vcd, "#%" PLI_UINT64_FMT "\n", now);
+}
+
+static void out_value(const struct flight_sig*sig, const PLI_UINT32*val)
+{
+      s_vpi_value_record rec;
+      char*str;
+
+      rec.size = sig->size;
+      if (sig->size == 0) memcpy(&rec.value.real, val, sizeof(double));
+      else rec.value.vector = (p_vpi_vecval)val;
+
+#ifdef HAVE_LIBZ
+      if (out_fst) {
+	    unsigned idx = sig - flight_sigs;
+	    if (sig->size == 0) {
+		  fstWriterEmitValueChange(out_fst, out_handles[idx],
+		                           &rec.value.real);
+	    } else {
+		  fstWriterEmitValueChange(out_fst, out_handles[idx],
+		                           vcd_record_to_str(&rec));
+	    }
+	    return;
+      }
+#endif
+
+      if (sig->size == 0) {
+	    fprintf(out_vcd, "r%.16g %s\n", rec.value.real, sig->ident);
+	    return;
+      }
+
+      str = vcd_record_to_str(&rec);
+      if (sig->size == 1) fprintf(out_vcd, "%s%s\n", str, sig->ident);
+      else fprintf(out_vcd, "b%s %s\n", str, sig->ident);
+}
+
+static void out_close(void)
+{
+#ifdef HAVE_LIBZ
+      if (out_fst) {
+	    fstWriterClose(out_fst);
+	    out_fst = 0;
+	    free(out_handles);
+	    out_handles = 0;
+	    return;
+      }
+#endif
+      fclose(out_vcd);
+      out_vcd = 0;
+}
+
+static int out_open(const char*path)
+{
+      const char*suffix = strrchr(path, '.');
+
+      if (suffix && strcmp(suffix, ".fst") == 0) {
+#ifdef HAVE_LIBZ
+	    out_fst = fstWriterCreate(path, 1);
+	    return out_fst != 0;
+#else
+	    vpi_printf("Flight recorder warning: FST support disabled since "
+	               "zlib not available, writing %s as VCD.\n", path);
+#endif
+      }
+
+      out_vcd = fopen(path, "w");
+      return out_vcd != 0;
+}
+
+/*
+ * Write the base values, then replay the ring, then add the values
+ * that changed in the present time step and are not recorded yet.
+ */
+static void flight_dump(const char*path, const char*why)
+{
+      PLI_UINT32*tmp = 0;
+      unsigned tmp_words = 0;
+      PLI_UINT64 last_time = base_time;
+      s_vpi_time now_rec;
+      PLI_UINT64 now;
+      size_t pos = ring_head;
+      unsigned idx, grp_idx;
+
+      if (! out_open(path)) {
+	    vpi_printf("Flight recorder error: unable to open %s for "
+	               "output.\n", path);
+	    return;
+      }
+
+      out_header(why);
+
+      out_time(base_time);
+#ifdef HAVE_LIBZ
+      if (!out_fst)
+#endif
+	    fprintf(out_vcd, "$dumpvars\n");
+      for (idx = 0 ; idx < flight_nsigs ; idx += 1) {
+	    struct flight_sig*sig = flight_sigs + idx;
+	    memcpy(sig->cur, sig->base, sig->words*sizeof(PLI_UINT32));
+	    out_value(sig, sig->cur);
+      }
+#ifdef HAVE_LIBZ
+      if (!out_fst)
+#endif
+	    fprintf(out_vcd, "$end\n");
+
+      for (grp_idx = 0 ; grp_idx < ring_groups ; grp_idx += 1) {
+	    PLI_UINT32*grp = ring + pos;
+	    PLI_UINT32*cp = grp + FLIGHT_HDR;
+	    PLI_UINT32*end = grp + grp[0];
+
+	    if (group_time(grp) != last_time) {
+		  last_time = group_time(grp);
+		  out_time(last_time);
+	    }
+	    while (cp < end) {
+		  struct flight_sig*sig = flight_sigs + cp[0];
+		  memcpy(sig->cur, cp+1, sig->words*sizeof(PLI_UINT32));
+		  out_value(sig, sig->cur);
+		  cp += 1 + sig->words;
+	    }
+
+	    pos += grp[0];
+	    if (ring_wrapped && pos == ring_wrap) pos = 0;
+      }
+
+      now_rec.type = vpiSimTime;
+      vpi_get_time(0, &now_rec);
+      now = timerec_to_time64(&now_rec);
+      for (idx = 0 ; idx < flight_nsigs ; idx += 1) {
+	    struct flight_sig*sig = flight_sigs + idx;
+	    if (sig->words > tmp_words) {
+		  tmp_words = sig->words;
+		  tmp = realloc(tmp, tmp_words*sizeof(PLI_UINT32));
+	    }
+	    get_current(tmp, sig);
+	    if (memcmp(tmp, sig->cur, sig->words*sizeof(PLI_UINT32)) == 0)
+		  continue;
+	    if (now != last_time) {
+		  last_time = now;
+		  out_time(now);
+	    }
+	    out_value(sig, tmp);
+      }
+      free(tmp);
+
+      out_close();
+
+      vpi_printf("Flight recorder: %s, wrote %s from time %" PLI_UINT64_FMT
+                 ".\n", why, path, base_time);
+}
+
+void sys_flight_trigger(const char*why)
+{
+      if (!flight_active) return;
+      flight_dump(flight_path ? flight_path : "flight.vcd", why);
+}
+
+static PLI_INT32 sys_flightrecorder_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle item;
+      s_vpi_value value;
+      s_vpi_time now;
+      PLI_UINT64 depth = 0;
+      PLI_INT32 units, prec;
+
+      if (flight_active) {
+	    vpi_printf("WARNING: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s was already called, ignoring this call.\n", name);
+	    if (argv) vpi_free_object(argv);
+	    return 0;
+      }
+
+	/* The depth is in the units of the calling scope. */
+      if (argv) {
+	    value.format = vpiIntVal;
+	    vpi_get_value(vpi_scan(argv), &value);
+	    if (value.value.integer > 0) depth = value.value.integer;
+      }
+      prec = vpi_get(vpiTimePrecision, 0);
+      units = vpi_get(vpiTimeUnit, vpi_handle(vpiScope, callh));
+      while (units > prec) {
+	    depth *= 10;
+	    units -= 1;
+      }
+      flight_depth = depth;
+
+	/* This records all the instances in the design if none are given. */
+      if (!argv || !(item = vpi_scan(argv))) {
+	    argv = vpi_iterate(vpiInstance, 0x0);
+	    assert(argv);
+	    item = vpi_scan(argv);
+      }
+
+      for ( ; item ; item = vpi_scan(argv)) {
+	    unsigned dep = draw_scope(item);
+	    scan_item(item);
+	    while (dep--) add_hdr(FLIGHT_UPSCOPE, 0, 0, 0);
+      }
+
+      ring_cap = flight_budget / sizeof(PLI_UINT32);
+      ring = malloc(ring_cap*sizeof(PLI_UINT32));
+
+      now.type = vpiSimTime;
+      vpi_get_time(0, &now);
+      base_time = timerec_to_time64(&now);
+      flight_active = 1;
+
+      return 0;
+}
+
+static PLI_INT32 sys_flightdump_compiletf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+
+	/* The file name is optional. */
+      if (argv == 0) return 0;
+
+      if (! is_string_obj(vpi_scan(argv))) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s's argument must be a file name string.\n", name);
+	    vpip_set_return_value(1);
+	    vpi_control(vpiFinish, 1);
+      }
+
+      check_for_extra_args(argv, callh, name, "one string argument", 1);
+
+      return 0;
+}
+
+static PLI_INT32 sys_flightdump_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      char*path = 0;
+
+      if (!flight_active) {
+	    vpi_printf("WARNING: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s called before $flightrecorder.\n", name);
+	    if (argv) vpi_free_object(argv);
+	    return 0;
+      }
+
+      if (argv) {
+	    path = get_filename(callh, name, vpi_scan(argv));
+	    vpi_free_object(argv);
+	    if (path == 0) return 0;
+      }
+
+      flight_dump(path ? path : (flight_path ? flight_path : "flight.vcd"),
+                  name);
+      free(path);
+      return 0;
+}
+
+static PLI_INT32 flight_end_of_sim(p_cb_data cause)
+{
+      unsigned idx;
+
+      (void)cause; /* Parameter is not used. */
+
+      for (idx = 0 ; idx < flight_nsigs ; idx += 1) {
+	    free(flight_sigs[idx].base);
+	    free(flight_sigs[idx].cur);
+      }
+      for (idx = 0 ; idx < flight_nhdrs ; idx += 1)
+	    free(flight_hdrs[idx].name);
+      free(flight_sigs);
+      free(flight_hdrs);
+      free(ring);
+      free(flight_path);
+      flight_sigs = 0;
+      flight_nsigs = 0;
+      flight_hdrs = 0;
+      flight_nhdrs = 0;
+      ring = 0;
+      flight_path = 0;
+      flight_active = 0;
+
+      return 0;
+}
+
+void sys_flight_register(void)
+{
+      s_vpi_systf_data tf_data;
+      s_cb_data cb_data;
+      struct t_vpi_vlog_info vlog_info;
+      vpiHandle res;
+      int idx;
+
+	/* Scan the extended arguments for the file and the budget. */
+      vpi_get_vlog_info(&vlog_info);
+
+      for (idx = 0 ;  idx < vlog_info.argc ;  idx += 1) {
+	    const char*arg = vlog_info.argv[idx];
+
+	    if (strncmp(arg, "-flight-file=", 13) == 0) {
+		  free(flight_path);
+		  flight_path = strdup(arg + 13);
+
+	    } else if (strncmp(arg, "-flight-budget=", 15) == 0) {
+		  char*end;
+		  unsigned shift = 0;
+		  unsigned long val = strtoul(arg + 15, &end, 10);
+		  switch (*end) {
+		      case 'k': case 'K': shift = 10; end += 1; break;
+		      case 'm': case 'M': shift = 20; end += 1; break;
+		      case 'g': case 'G': shift = 30; end += 1; break;
+		  }
+		  if (*end || end == arg + 15 || ! isdigit((int)arg[15])
+		      || val == ULONG_MAX || val > (ULONG_MAX >> shift)) {
+			vpi_printf("Flight recorder warning: Ignoring invalid "
+			           "budget %s.\n", arg + 15);
+		  } else {
+			flight_budget = val << shift;
+		  }
+	    }
+      }
+
+      tf_data.type      = vpiSysTask;
+      tf_data.tfname    = "$flightrecorder";
+      tf_data.calltf    = sys_flightrecorder_calltf;
+      tf_data.compiletf = sys_dumpvars_compiletf;
+      tf_data.sizetf    = 0;
+      tf_data.user_data = "$flightrecorder";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
+      tf_data.type      = vpiSysTask;
+      tf_data.tfname    = "$flightdump";
+      tf_data.calltf    = sys_flightdump_calltf;
+      tf_data.compiletf = sys_flightdump_compiletf;
+      tf_data.sizetf    = 0;
+      tf_data.user_data = "$flightdump";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
+      cb_data.reason = cbEndOfSimulation;
+      cb_data.time = 0;
+      cb_data.cb_rtn = flight_end_of_sim;
+      cb_data.user_data = 0x0;
+      cb_data.obj = 0x0;
+      vpi_register_cb(&cb_data);
+}
@@ -64,6 +64,13 @@ static enum lxm_optimum_mode_e {
       LXM_BOTH = 3
 } lxm_optimum_mode = LXM_NONE;
 
+  /* The -fst-pack= compression for the value change blocks, or -1 to
+   * use the one that the optimum mode picks. */
+static int fst_pack_type = -1;
+  /* Compress and write the value change blocks on a background
+   * thread so the simulation does not wait for each block. */
+static int fst_parallel = 0;
+
 static const char*units_names[] = {
       "s",
       "ms",
@@ -197,6 +204,53 @@ static PLI_INT32 variable_cb_1(p_cb_data cause)
       return 0;
 }
 
+static void show_this_record(const s_vpi_value_record*rec)
+{
+      struct vcd_info*info = (struct vcd_info*)rec->user_data;
+
+      if (rec->size == 0) {
+	    fstWriterEmitValueChange(dump_file, info->handle, &rec->value.real);
+      } else {
+	    fstWriterEmitValueChange(dump_file, info->handle,
+	                             vcd_record_to_str(rec));
+      }
+}
+
+/*
+ * The run time calls this once at the end of each time step with all
+ * the recorded signals that changed in the step, and their values.
+ */
+static PLI_INT32 variable_record_cb(p_cb_data cause)
+{
+      p_vpi_value_record rec = (p_vpi_value_record)cause->value->value.misc;
+      PLI_UINT64 now = timerec_to_time64(cause->time);
+      PLI_INT32 idx;
+
+      if (dump_is_full) return 0;
+      if (dump_is_off) return 0;
+	/* The $dumpvars checkpoint already has the values of this step. */
+      if (dump_header_pending() || now == dumpvars_time) return 0;
+
+      if ((dump_limit > 0) && fstWriterGetDumpSizeLimitReached(dump_file)) {
+            dump_is_full = 1;
+            vpi_printf("WARNING: Dump file limit (%ld bytes) "
+                               "exceeded.\n", dump_limit);
+            return 0;
+      }
+
+      if (now != vcd_cur_time) {
+	    fstWriterEmitTimeChange(dump_file, now);
+	    vcd_cur_time = now;
+      }
+
+	/* The records are in the order of the changes. Emit them
+	 * last first as the value change callbacks would. */
+      for (idx = cause->index ; idx > 0 ; idx -= 1)
+	    show_this_record(rec + idx - 1);
+
+      return 0;
+}
+
 static PLI_INT32 dumpvars_cb(p_cb_data cause)
 {
       if (dumpvars_status != 1) return 0;
@@ -404,10 +458,14 @@ static void open_dumpfile(vpiHandle callh)
 	    sprintf(scale_buf, "\t%u%s\n", scale, units_names[udx]);
 	    fstWriterSetTimescaleFromString(dump_file, scale_buf);
 	      /* Set the faster dump type when requested. */
-	    if ((lxm_optimum_mode == LXM_SPEED) ||
-	        (lxm_optimum_mode == LXM_BOTH)) {
-		  fstWriterSetPackType(dump_file, 1);
+	    if (fst_pack_type >= 0) {
+		  fstWriterSetPackType(dump_file,
+		                       (enum fstWriterPackType)fst_pack_type);
+	    } else if ((lxm_optimum_mode == LXM_SPEED) ||
+	               (lxm_optimum_mode == LXM_BOTH)) {
+		  fstWriterSetPackType(dump_file, FST_WR_PT_FASTLZ);
 	    }
+	    if (fst_parallel) fstWriterSetParallelMode(dump_file, 1);
 	      /* Set the most effective compression when requested. */
 	    if ((lxm_optimum_mode == LXM_SPACE) ||
 	        (lxm_optimum_mode == LXM_BOTH)) {
@@ -651,14 +709,21 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		  cb.user_data = (char*)info;
 		  cb.value     = NULL;
 		  cb.obj       = item;
-		  cb.reason    = cbValueChange;
-		  cb.cb_rtn    = variable_cb_1;
+		  cb.reason    = _cbValueRecord;
+		  cb.cb_rtn    = variable_record_cb;
 
 		  info->dmp_next = 0;
 		  info->next  = vcd_list;
 		  vcd_list    = info;
 
+		    /* Let the run time record the changes if it can,
+		     * otherwise get a callback for each change. */
 		  info->cb    = vpi_register_cb(&cb);
+		  if (info->cb == 0) {
+			cb.reason = cbValueChange;
+			cb.cb_rtn = variable_cb_1;
+			info->cb  = vpi_register_cb(&cb);
+		  }
 	    }
 
 	    break;
@@ -918,6 +983,25 @@ void sys_fst_register(void)
 		  lxm_optimum_mode = LXM_BOTH;
 	    } else if (strcmp(vlog_info.argv[idx],"-fst-speed-space") == 0) {
 		  lxm_optimum_mode = LXM_BOTH;
+
+	    } else if (strcmp(vlog_info.argv[idx],"-fst-pack=zlib") == 0) {
+		  fst_pack_type = FST_WR_PT_ZLIB;
+	    } else if (strcmp(vlog_info.argv[idx],"-fst-pack=fastlz") == 0) {
+		  fst_pack_type = FST_WR_PT_FASTLZ;
+	    } else if (strcmp(vlog_info.argv[idx],"-fst-pack=lz4") == 0) {
+		  fst_pack_type = FST_WR_PT_LZ4;
+	    } else if (strncmp(vlog_info.argv[idx],"-fst-pack=", 10) == 0) {
+		  vpi_printf("FST warning: Unknown compression %s, "
+		             "expected zlib, fastlz or lz4.\n",
+		             vlog_info.argv[idx]+10);
+
+	    } else if (strcmp(vlog_info.argv[idx],"-fst-parallel") == 0) {
+#ifdef HAVE_LIBPTHREAD
+		  fst_parallel = 1;
+#else
+		  vpi_printf("FST warning: -fst-parallel is not supported "
+		             "without threads.\n");
+#endif
 	    }
       }
 
@@ -64,6 +64,12 @@ extern unsigned get_fd_mcd_from_arg(PLI_UINT32 *fd_mcd, vpiHandle arg,
 
 extern vpiHandle sys_func_module(vpiHandle obj);
 
+/*
+ * Write out the flight recorder, if one was started, because of the
+ * given failure.
+ */
+extern void sys_flight_trigger(const char*why);
+
 /*
  * The standard compiletf routines.
  */
@@ -23,8 +23,11 @@
 # include  <stdlib.h>
 # include  <stdio.h>
 # include  <assert.h>
-# include  "sys_readmem_lex.h"
+# include  <limits.h>
 # include  <sys/stat.h>
+# ifndef __MINGW32__
+# include  <sys/mman.h>
+# endif
 # include  "ivl_alloc.h"
 
 char **search_list = NULL;
@@ -269,17 +272,408 @@ static PLI_INT32 sys_mem_compiletf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return 0;
 }
 
+/*
+ * The memory file is scanned in place. Where the system has mmap the
+ * file is mapped, otherwise (or if the file is a pipe or some other
+ * thing that cannot be mapped) it is read into a buffer.
+ */
+struct mem_file {
+      const char*data;
+      size_t size;
+      int mapped;
+};
+
+static void read_mem_file(FILE*file, struct mem_file*mf)
+{
+      size_t alloc = 64*1024;
+      char*buf = malloc(alloc);
+      size_t cnt;
+
+      mf->size = 0;
+      while ((cnt = fread(buf + mf->size, 1, alloc - mf->size, file)) > 0) {
+	    mf->size += cnt;
+	    if (mf->size == alloc) {
+		  alloc *= 2;
+		  buf = realloc(buf, alloc);
+	    }
+      }
+      mf->data = buf;
+      mf->mapped = 0;
+}
+
+static void open_mem_file(FILE*file, struct mem_file*mf)
+{
+#ifndef __MINGW32__
+      struct stat sb;
+      int fd = fileno(file);
+
+      if (fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode) && sb.st_size > 0
+	  && (off_t)(size_t)sb.st_size == sb.st_size) {
+	    void*map = mmap(0, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE,
+	                    fd, 0);
+	    if (map != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+		  madvise(map, (size_t)sb.st_size, MADV_SEQUENTIAL);
+#endif
+		  mf->data = map;
+		  mf->size = (size_t)sb.st_size;
+		  mf->mapped = 1;
+		  return;
+	    }
+      }
+#endif
+      read_mem_file(file, mf);
+}
+
+static void close_mem_file(struct mem_file*mf)
+{
+#ifndef __MINGW32__
+      if (mf->mapped) {
+	    munmap((void*)mf->data, mf->size);
+	    return;
+      }
+#endif
+      free((char*)mf->data);
+}
+
+/*
+ * This is the scanner for the memory files. It returns the tokens
+ * that the old flex scanner did: a MEM_ADDRESS for @ and hex digits,
+ * a MEM_WORD for a run of hex (or binary) digits, x, z and _
+ * characters, and a MEM_ERROR for any single character that cannot
+ * start a token. White space and C and C++ style comments are
+ * skipped. The digit tables map a character to its value, to DIG_X,
+ * DIG_Z or DIG_SKIP, or to DIG_BAD if it is not part of a word.
+ */
+# define MEM_ADDRESS 257
+# define MEM_WORD    258
+# define MEM_ERROR   259
+
+# define DIG_X    16
+# define DIG_Z    17
+# define DIG_SKIP 18
+# define DIG_BAD  -1
+
+static signed char hex_digit[256];
+static signed char bin_digit[256];
+
+static void init_digit_tables(void)
+{
+      static int done = 0;
+      unsigned idx;
+
+      if (done) return;
+      done = 1;
+
+      for (idx = 0 ; idx < 256 ; idx += 1) {
+	    hex_digit[idx] = DIG_BAD;
+	    bin_digit[idx] = DIG_BAD;
+      }
+      for (idx = 0 ; idx < 10 ; idx += 1) hex_digit['0'+idx] = idx;
+      for (idx = 0 ; idx < 6 ; idx += 1) {
+	    hex_digit['a'+idx] = 10 + idx;
+	    hex_digit['A'+idx] = 10 + idx;
+      }
+      bin_digit['0'] = 0;
+      bin_digit['1'] = 1;
+
+      hex_digit['x'] = hex_digit['X'] = DIG_X;
+      hex_digit['z'] = hex_digit['Z'] = DIG_Z;
+      hex_digit['_'] = DIG_SKIP;
+      bin_digit['x'] = bin_digit['X'] = DIG_X;
+      bin_digit['z'] = bin_digit['Z'] = DIG_Z;
+      bin_digit['_'] = DIG_SKIP;
+}
+
+static int is_hex_value(char ch)
+{
+      int val = hex_digit[(unsigned char)ch];
+      return val >= 0 && val < 16;
+}
+
+struct mem_scan {
+      const char*cur;
+      const char*end;
+      const signed char*digit;
+	/* The text of the last token. */
+      const char*tok;
+      size_t len;
+};
+
+static int mem_scan_next(struct mem_scan*sc)
+{
+      const char*cp = sc->cur;
+      const char*end = sc->end;
+
+      for (;;) {
+	    while (cp < end && (*cp == ' ' || *cp == '\t' || *cp == '\f'
+	                        || *cp == '\n' || *cp == '\r'))
+		  cp += 1;
+	    if (cp == end) {
+		  sc->cur = cp;
+		  return 0;
+	    }
+	    if (*cp != '/' || cp+1 == end) break;
+
+	    if (cp[1] == '/') {
+		  cp = memchr(cp, '\n', end - cp);
+		  if (cp == 0) cp = end;
+	    } else if (cp[1] == '*') {
+		    /* An unterminated comment runs to the end of file. */
+		  const char*star = cp + 2;
+		  cp = end;
+		  while ((star = memchr(star, '*', end - star))) {
+			star += 1;
+			if (star == end) break;
+			if (*star == '/') {
+			      cp = star + 1;
+			      break;
+			}
+		  }
+	    } else {
+		  break;
+	    }
+      }
+
+      sc->tok = cp;
+      if (*cp == '@' && cp+1 < end && is_hex_value(cp[1])) {
+	    cp += 1;
+	    while (cp < end && is_hex_value(*cp)) cp += 1;
+	    sc->len = cp - sc->tok;
+	    sc->cur = cp;
+	    return MEM_ADDRESS;
+      }
+
+      if (sc->digit[(unsigned char)*cp] != DIG_BAD) {
+	    while (cp < end && sc->digit[(unsigned char)*cp] != DIG_BAD)
+		  cp += 1;
+	    sc->len = cp - sc->tok;
+	    sc->cur = cp;
+	    return MEM_WORD;
+      }
+
+      sc->len = 1;
+      sc->cur = cp + 1;
+      return MEM_ERROR;
+}
+
+/*
+ * Get the address of a MEM_ADDRESS token. This converts the way that
+ * the "%x" conversion that was used before does: the digits are read
+ * as an unsigned long that saturates, and that is truncated.
+ */
+static int mem_scan_address(const struct mem_scan*sc)
+{
+      unsigned long val = 0;
+      size_t idx;
+
+      for (idx = 1 ; idx < sc->len ; idx += 1) {
+	    if (val > (ULONG_MAX >> 4)) {
+		  val = ULONG_MAX;
+		  break;
+	    }
+	    val = (val << 4) | hex_digit[(unsigned char)sc->tok[idx]];
+      }
+      return (int)(PLI_UINT32)val;
+}
+
+static const unsigned BITS_PER_LONG = 8*sizeof(unsigned long);
+
+/*
+ * Convert a MEM_WORD token to the raw words of a width bit value. The
+ * digits are taken from the right, and any digits that do not fit are
+ * counted and reported once per $readmem call.
+ */
+static void mem_scan_word(const struct mem_scan*sc, int bin_flag,
+                          unsigned width, unsigned long*aval,
+                          unsigned long*bval, vpiHandle callh,
+                          int*warned)
+{
+      unsigned dbits = bin_flag? 1 : 4;
+      unsigned long dmask = bin_flag? 1 : 15;
+      unsigned need = (width + dbits - 1) / dbits;
+      unsigned wcnt = (width + BITS_PER_LONG - 1) / BITS_PER_LONG;
+      const char*beg = sc->tok;
+      const char*cp = beg + sc->len;
+      unsigned pos = 0, idx;
+      int extra = 0;
+
+      for (idx = 0 ; idx < wcnt ; idx += 1) {
+	    aval[idx] = 0;
+	    bval[idx] = 0;
+      }
+
+      while (need > 0 && cp > beg) {
+	    unsigned long abit, bbit;
+	    int val = sc->digit[(unsigned char)*--cp];
+
+	    switch (val) {
+		case DIG_SKIP:
+		  continue;
+		case DIG_X:
+		  abit = dmask;
+		  bbit = dmask;
+		  break;
+		case DIG_Z:
+		  abit = 0;
+		  bbit = dmask;
+		  break;
+		default:
+		  abit = val;
+		  bbit = 0;
+		  break;
+	    }
+
+	    aval[pos / BITS_PER_LONG] |= abit << (pos % BITS_PER_LONG);
+	    bval[pos / BITS_PER_LONG] |= bbit << (pos % BITS_PER_LONG);
+	    pos += dbits;
+	    need -= 1;
+      }
+
+	/* If there are more text digits then needed to fill the
+	   memory word, count those digits and print a warning
+	   message. Print that warning only once per call to
+	   $readmem() so that the user isn't flooded. */
+      while (cp > beg) {
+	    if (*--cp != '_') extra += 1;
+      }
+
+      if (extra && *warned == 0) {
+	    vpi_printf("WARNING: %s:%d: Excess %s digits (%d of '%.*s') "
+	               "while reading %u-bit words.\n",
+	               vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh),
+	               bin_flag? "binary" : "hex", extra,
+	               (int)sc->len, beg, width);
+	    *warned = 1;
+      }
+}
+
+/*
+ * The words that are read are collected in a chunk and stored in the
+ * memory a run of consecutive addresses at a time with the
+ * _vpiRawArrayVal format. A run is stored when the chunk is full or
+ * the next word is not at the next address.
+ */
+static const unsigned CHUNK_LONGS = 64*1024;
+
+struct mem_chunk {
+      vpiHandle mitem;
+      unsigned width;
+      unsigned wcnt;
+      unsigned cap;
+      int incr;
+	/* The first address of the run, the number of words in it,
+	   and the address that the next word must have to join it. */
+      int first;
+      unsigned fill;
+      int next;
+      unsigned long*aval;
+      unsigned long*bval;
+};
+
+static void mem_chunk_init(struct mem_chunk*ch, vpiHandle mitem,
+                           unsigned width, int incr)
+{
+      ch->mitem = mitem;
+      ch->width = width;
+      ch->wcnt = (width + BITS_PER_LONG - 1) / BITS_PER_LONG;
+      ch->cap = CHUNK_LONGS / ch->wcnt;
+      if (ch->cap == 0) ch->cap = 1;
+      ch->incr = incr;
+      ch->first = 0;
+      ch->fill = 0;
+      ch->next = 0;
+      ch->aval = malloc(2 * ch->cap * ch->wcnt * sizeof(unsigned long));
+      ch->bval = ch->aval + ch->cap * ch->wcnt;
+}
+
+/*
+ * Get or put the words of a run. The words of a descending run are
+ * kept at the end of the chunk, so that they are in order of
+ * increasing address either way.
+ */
+static void mem_chunk_access(struct mem_chunk*ch, int put_flag)
+{
+      s_vpi_raw_array raw;
+      s_vpi_value val;
+      unsigned off = ch->incr > 0? 0 : (ch->cap - ch->fill) * ch->wcnt;
+
+      raw.index = ch->incr > 0? ch->first : ch->first - (int)ch->fill + 1;
+      raw.count = ch->fill;
+      raw.size = ch->width;
+      raw.aval = ch->aval + off;
+      raw.bval = ch->bval + off;
+
+      val.format = _vpiRawArrayVal;
+      val.value.misc = (char*)&raw;
+      if (put_flag) vpi_put_value(ch->mitem, &val, 0, vpiNoDelay);
+      else vpi_get_value(ch->mitem, &val);
+}
+
+static void mem_chunk_flush(struct mem_chunk*ch)
+{
+      if (ch->fill == 0) return;
+      mem_chunk_access(ch, 1);
+      ch->fill = 0;
+}
+
+/*
+ * Return the slot of the word for addr, storing the words that are
+ * already in the chunk if addr does not continue the run.
+ */
+static unsigned mem_chunk_slot(struct mem_chunk*ch, int addr)
+{
+      unsigned slot;
+
+      if (ch->fill > 0 && (addr != ch->next || ch->fill == ch->cap))
+	    mem_chunk_flush(ch);
+
+      if (ch->fill == 0) ch->first = addr;
+      slot = ch->incr > 0? ch->fill : ch->cap - ch->fill - 1;
+      ch->fill += 1;
+      ch->next = addr + ch->incr;
+      return slot * ch->wcnt;
+}
+
+static void mem_chunk_free(struct mem_chunk*ch)
+{
+      free(ch->aval);
+}
+
+/* Set by the -readmem-progress extended argument. */
+static int readmem_progress = 0;
+
+static void report_progress(const char*name, const char*fname,
+                            size_t done, size_t size, unsigned*step)
+{
+      unsigned now;
+
+      if (! readmem_progress || size == 0) return;
+
+      now = (unsigned)((double)done * 10 / size);
+      if (now <= *step) return;
+      *step = now;
+      vpi_printf("%s(%s): %u%% of %lu bytes read.\n", name, fname,
+                 now * 10, (unsigned long)size);
+}
+
 static PLI_INT32 sys_readmem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       int code, wwid, addr;
       FILE*file;
       char *fname = 0;
-      s_vpi_value value;
       vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
       vpiHandle argv = vpi_iterate(vpiArgument, callh);
       vpiHandle mitem = 0;
       vpiHandle start_item = 0;
       vpiHandle stop_item = 0;
+      int bin_flag = strcmp(name, "$readmemb") == 0;
+      int warned = 0;
+      unsigned step = 0;
+      struct mem_file mf;
+      struct mem_scan sc;
+      struct mem_chunk ch;
 
       /* start_addr and stop_addr are the parameters given to $readmem in the
 	 Verilog code. When not specified, start_addr is equal to the lower of
@@ -336,25 +730,21 @@ static PLI_INT32 sys_readmem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 
       wwid = vpi_get(vpiSize, vpi_handle_by_index(mitem, min_addr));
 
-      /* variable that will be used by the lexer to pass values
-	 back to this code */
-      value.format = vpiVectorVal;
-      value.value.vector = calloc((wwid+31)/32, sizeof(s_vpi_vecval));
-
-      /* Configure the readmem lexer */
-      if (strcmp(name,"$readmemb") == 0)
-	    sys_readmem_start_file(callh, file, 1, wwid, value.value.vector);
-      else
-	    sys_readmem_start_file(callh, file, 0, wwid, value.value.vector);
-
       /*======================================== Read memory file */
 
+      init_digit_tables();
+      open_mem_file(file, &mf);
+      sc.cur = mf.data;
+      sc.end = mf.data + mf.size;
+      sc.digit = bin_flag? bin_digit : hex_digit;
+      mem_chunk_init(&ch, mitem, wwid, addr_incr);
+
       /* Run through the input file and store the new contents in the memory */
       addr = start_addr;
-      while ((code = readmemlex()) != 0) {
+      while ((code = mem_scan_next(&sc)) != 0) {
 	  switch (code) {
 	  case MEM_ADDRESS:
-	      addr = value.value.vector->aval;
+	      addr = mem_scan_address(&sc);
 	      if (addr < min_addr || addr > max_addr) {
 		  vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
 		             (int)vpi_get(vpiLineNo, callh));
@@ -372,10 +762,12 @@ static PLI_INT32 sys_readmem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 
 	  case MEM_WORD:
 	      if (addr >= min_addr && addr <= max_addr) {
-		  vpiHandle word_index;
-		  word_index = vpi_handle_by_index(mitem, addr);
-		  assert(word_index);
-		  vpi_put_value(word_index, &value, 0, vpiNoDelay);
+		  unsigned slot = mem_chunk_slot(&ch, addr);
+		  mem_scan_word(&sc, bin_flag, wwid, ch.aval + slot,
+		                ch.bval + slot, callh, &warned);
+		  if (ch.fill == ch.cap)
+			report_progress(name, fname, sc.cur - mf.data,
+			                mf.size, &step);
 
 		  if (word_count > 0) word_count -= 1;
 	      } else {
@@ -393,8 +785,8 @@ static PLI_INT32 sys_readmem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 	  case MEM_ERROR:
 	      vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
 	                 (int)vpi_get(vpiLineNo, callh));
-	      vpi_printf("%s(%s): Invalid input character: %s\n", name,
-	                 fname, readmem_error_token);
+	      vpi_printf("%s(%s): Invalid input character: %.1s\n", name,
+	                 fname, sc.tok);
 	      goto bailout;
 	      break;
 
@@ -414,10 +806,13 @@ static PLI_INT32 sys_readmem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       }
 
  bailout:
-      free(value.value.vector);
+	/* The words read before any error are still stored. */
+      mem_chunk_flush(&ch);
+      report_progress(name, fname, sc.cur - mf.data, mf.size, &step);
+      mem_chunk_free(&ch);
+      close_mem_file(&mf);
       free(fname);
       fclose(file);
-      destroy_readmem_lexor();
       return 0;
 }
 
@@ -520,21 +915,69 @@ static PLI_INT32 sys_readmempath_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return 0;
 }
 
+/*
+ * Format the word at aval/bval as the text that the vpiHexStrVal or
+ * vpiBinStrVal format would give, followed by a newline. Return a
+ * pointer past the text.
+ */
+static char* format_mem_word(char*cp, int bin_flag, unsigned width,
+                             const unsigned long*aval,
+                             const unsigned long*bval)
+{
+      unsigned pos;
+
+      if (bin_flag) {
+	    pos = width;
+	    while (pos > 0) {
+		  unsigned long a, b;
+		  pos -= 1;
+		  a = (aval[pos / BITS_PER_LONG] >> (pos % BITS_PER_LONG)) & 1;
+		  b = (bval[pos / BITS_PER_LONG] >> (pos % BITS_PER_LONG)) & 1;
+		  *cp++ = "01zx"[a | b << 1];
+	    }
+	    *cp++ = '\n';
+	    return cp;
+      }
+
+      pos = (width + 3) / 4 * 4;
+      while (pos > 0) {
+	    unsigned long a, b, m, xb;
+	    pos -= 4;
+	    a = (aval[pos / BITS_PER_LONG] >> (pos % BITS_PER_LONG)) & 15;
+	    b = (bval[pos / BITS_PER_LONG] >> (pos % BITS_PER_LONG)) & 15;
+	    if (b == 0) {
+		  *cp++ = "0123456789abcdef"[a];
+		  continue;
+	    }
+	      /* Only the bits of a partial top digit count. */
+	    m = width - pos < 4? (1UL << (width - pos)) - 1 : 15;
+	    xb = a & b;
+	    if ((b & ~a & m) == m) *cp++ = 'z';
+	    else if (xb == m) *cp++ = 'x';
+	    else if (xb == 0) *cp++ = 'Z';
+	    else *cp++ = 'X';
+      }
+      *cp++ = '\n';
+      return cp;
+}
+
 static PLI_INT32 sys_writemem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       int addr;
       FILE*file;
       char*fname = 0;
-      unsigned cnt;
-      s_vpi_value value;
+      char*text;
+      unsigned cnt, wwid, left;
       vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
       vpiHandle argv = vpi_iterate(vpiArgument, callh);
       vpiHandle mitem = 0;
       vpiHandle start_item = 0;
       vpiHandle stop_item = 0;
+      int bin_flag = strcmp(name, "$writememb") == 0;
+      struct mem_chunk ch;
 
       int start_addr, stop_addr, addr_incr;
-      int min_addr, max_addr; // Not used in this routine.
+      int min_addr, max_addr;
 
       /*======================================== Get parameters */
 
@@ -562,23 +1005,44 @@ static PLI_INT32 sys_writemem_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 	    return 0;
       }
 
-      if (strcmp(name,"$writememb")==0) value.format = vpiBinStrVal;
-      else value.format = vpiHexStrVal;
-
       /*======================================== Write memory file */
 
+	/* The words are fetched a chunk at a time, and the text for
+	   a chunk is written with a single call. */
+      wwid = vpi_get(vpiSize, vpi_handle_by_index(mitem, min_addr));
+      mem_chunk_init(&ch, mitem, wwid, addr_incr);
+      text = malloc(ch.cap * ((bin_flag? wwid : (wwid+3)/4) + 1)
+                    + (ch.cap/16 + 1) * 16);
+
       cnt = 0;
-      for(addr=start_addr; addr!=stop_addr+addr_incr; addr+=addr_incr, ++cnt) {
-	  vpiHandle word_index;
+      addr = start_addr;
+      left = max_addr - min_addr + 1;
+      while (left > 0) {
+	    char*cp = text;
+	    unsigned idx;
+
+	    ch.first = addr;
+	    ch.fill = left < ch.cap? left : ch.cap;
+	    mem_chunk_access(&ch, 0);
+
+	    for (idx = 0 ; idx < ch.fill ; idx += 1, ++cnt) {
+		  unsigned slot = addr_incr > 0? idx : ch.cap - idx - 1;
 
-	  if (cnt%16 == 0) fprintf(file, "// 0x%08x\n", cnt);
+		  if (cnt%16 == 0)
+			cp += sprintf(cp, "// 0x%08x\n", cnt);
 
-	  word_index = vpi_handle_by_index(mitem, addr);
-	  assert(word_index);
-	  vpi_get_value(word_index, &value);
-	  fprintf(file, "%s\n", value.value.str);
+		  cp = format_mem_word(cp, bin_flag, wwid,
+		                       ch.aval + slot*ch.wcnt,
+		                       ch.bval + slot*ch.wcnt);
+	    }
+	    fwrite(text, 1, cp - text, file);
+
+	    addr += (int)ch.fill * addr_incr;
+	    left -= ch.fill;
       }
 
+      free(text);
+      mem_chunk_free(&ch);
       fclose(file);
       free(fname);
       return 0;
@@ -589,6 +1053,14 @@ void sys_readmem_register(void)
       s_vpi_systf_data tf_data;
       vpiHandle res;
       s_cb_data cb_data;
+      struct t_vpi_vlog_info vlog_info;
+      int idx;
+
+      vpi_get_vlog_info(&vlog_info);
+      for (idx = 0 ;  idx < vlog_info.argc ;  idx += 1) {
+	    if (strcmp(vlog_info.argv[idx], "-readmem-progress") == 0)
+		  readmem_progress = 1;
+      }
 
       tf_data.type      = vpiSysTask;
       tf_data.tfname    = "$readmemh";
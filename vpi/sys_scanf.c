@@ -500,6 +500,7 @@ static int scan_format_decimal(vpiHandle callh, vpiHandle argv,
 	    strval[1] = 0;
       } else {
 	    unsigned len = 0;
+	    unsigned alloc = 1;
 
 	      /* To match a + or - we must have a digit after it. */
 	    if (ch == '+') {
@@ -528,7 +529,8 @@ static int scan_format_decimal(vpiHandle callh, vpiHandle argv,
 
 		  ch = byte_getc(src);
 		  if (isdigit(ch)) {
-			strval = realloc(strval, len+2);
+			alloc = 32;
+			strval = realloc(strval, alloc);
 			strval[len++] = '-';
 		  } else {
 			byte_ungetc(src, ch);
@@ -537,9 +539,14 @@ static int scan_format_decimal(vpiHandle callh, vpiHandle argv,
 		  }
 	    }
 
-	      /* Get all the characters, but no more than width. */
+	      /* Get all the characters, but no more than width. The
+	       * buffer is doubled as needed so that a long value does
+	       * not take a realloc() per digit. */
 	    while ((isdigit(ch) || ch == '_') && (len < width)) {
-		  strval = realloc(strval, len+2);
+		  if (len+2 > alloc) {
+			alloc = 2*(len+2) < 32? 32 : 2*(len+2);
+			strval = realloc(strval, alloc);
+		  }
 		  strval[len++] = ch;
 
 		  ch = byte_getc(src);
@@ -27,6 +27,7 @@ extern void sys_convert_register(void);
 extern void sys_countdrivers_register(void);
 extern void sys_darray_register(void);
 extern void sys_fileio_register(void);
+extern void sys_flight_register(void);
 extern void sys_finish_register(void);
 extern void sys_deposit_register(void);
 extern void sys_display_register(void);
@@ -201,6 +202,7 @@ void (*vlog_startup_routines[])(void) = {
       sys_darray_register,
       sys_fileio_register,
       sys_finish_register,
+      sys_flight_register,
       sys_deposit_register,
       sys_display_register,
       sys_plusargs_register,
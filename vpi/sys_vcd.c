@@ -109,17 +109,17 @@ static void show_this_item(struct vcd_info*info)
       if (type == vpiRealVar) {
 	    value.format = vpiRealVal;
 	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "r%.16g %s\n", value.value.real, info->ident);
+	    vcd_out_printf("r%.16g %s\n", value.value.real, info->ident);
       } else if (type == vpiNamedEvent) {
-	    fprintf(dump_file, "1%s\n", info->ident);
+	    vcd_out_printf("1%s\n", info->ident);
       } else if (vpi_get(vpiSize, info->item) == 1) {
 	    value.format = vpiBinStrVal;
 	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "%s%s\n", value.value.str, info->ident);
+	    vcd_out_printf("%s%s\n", value.value.str, info->ident);
       } else {
 	    value.format = vpiBinStrVal;
 	    vpi_get_value(info->item, &value);
-	    fprintf(dump_file, "b%s %s\n", truncate_bitvec(value.value.str),
+	    vcd_out_printf("b%s %s\n", truncate_bitvec(value.value.str),
 		    info->ident);
       }
 }
@@ -131,13 +131,13 @@ static void show_this_item_x(struct vcd_info*info)
 
       if (type == vpiRealVar) {
 	      /* Some tools dump nothing here...? */
-	    fprintf(dump_file, "rNaN %s\n", info->ident);
+	    vcd_out_printf("rNaN %s\n", info->ident);
       } else if (type == vpiNamedEvent) {
 	    /* Do nothing for named events. */
       } else if (vpi_get(vpiSize, info->item) == 1) {
-	    fprintf(dump_file, "x%s\n", info->ident);
+	    vcd_out_printf("x%s\n", info->ident);
       } else {
-	    fprintf(dump_file, "bx %s\n", info->ident);
+	    vcd_out_printf("bx %s\n", info->ident);
       }
 }
 
@@ -183,7 +183,7 @@ static PLI_INT32 variable_cb_2(p_cb_data cause)
       PLI_UINT64 now = timerec_to_time64(cause->time);
 
       if (now != vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now);
+	    vcd_out_printf("#%" PLI_UINT64_FMT "\n", now);
 	    vcd_cur_time = now;
       }
 
@@ -207,11 +207,11 @@ static PLI_INT32 variable_cb_1(p_cb_data cause)
       if (dump_header_pending()) return 0;
       if (info->scheduled) return 0;
 
-      if ((dump_limit > 0) && (ftell(dump_file) > dump_limit)) {
+      if ((dump_limit > 0) && (vcd_out_bytes() > (PLI_UINT64)dump_limit)) {
             dump_is_full = 1;
             vpi_printf("WARNING: Dump file limit (%ld bytes) "
                                "exceeded.\n", dump_limit);
-            fprintf(dump_file, "$comment Dump file limit (%ld bytes) "
+            vcd_out_printf("$comment Dump file limit (%ld bytes) "
                                "exceeded. $end\n", dump_limit);
             return 0;
       }
@@ -231,6 +231,80 @@ static PLI_INT32 variable_cb_1(p_cb_data cause)
       return 0;
 }
 
+/*
+ * Format a recorded value straight into the output buffer. Nearly
+ * all the value changes take this path, so it avoids printf.
+ */
+static void show_this_record(const s_vpi_value_record*rec)
+{
+      struct vcd_info*info = (struct vcd_info*)rec->user_data;
+      size_t ident_len = strlen(info->ident);
+      size_t bits_len;
+      char *str, *bits, *cp;
+
+      if (rec->size == 0) {
+	    vcd_out_printf("r%.16g %s\n", rec->value.real, info->ident);
+	    return;
+      }
+
+      str = vcd_record_to_str(rec);
+      if (rec->size == 1) {
+	    cp = vcd_out_reserve(ident_len + 2);
+	    cp[0] = str[0];
+	    memcpy(cp + 1, info->ident, ident_len);
+	    cp[ident_len + 1] = '\n';
+	    vcd_out_commit(ident_len + 2);
+	    return;
+      }
+
+      bits = truncate_bitvec(str);
+      bits_len = rec->size - (bits - str);
+      cp = vcd_out_reserve(bits_len + ident_len + 3);
+      cp[0] = 'b';
+      memcpy(cp + 1, bits, bits_len);
+      cp[bits_len + 1] = ' ';
+      memcpy(cp + bits_len + 2, info->ident, ident_len);
+      cp[bits_len + ident_len + 2] = '\n';
+      vcd_out_commit(bits_len + ident_len + 3);
+}
+
+/*
+ * The run time calls this once at the end of each time step with all
+ * the recorded signals that changed in the step, and their values.
+ */
+static PLI_INT32 variable_record_cb(p_cb_data cause)
+{
+      p_vpi_value_record rec = (p_vpi_value_record)cause->value->value.misc;
+      PLI_UINT64 now = timerec_to_time64(cause->time);
+      PLI_INT32 idx;
+
+      if (dump_is_full) return 0;
+      if (dump_is_off) return 0;
+	/* The $dumpvars checkpoint already has the values of this step. */
+      if (dump_header_pending() || now == dumpvars_time) return 0;
+
+      if ((dump_limit > 0) && (vcd_out_bytes() > (PLI_UINT64)dump_limit)) {
+            dump_is_full = 1;
+            vpi_printf("WARNING: Dump file limit (%ld bytes) "
+                               "exceeded.\n", dump_limit);
+            vcd_out_printf("$comment Dump file limit (%ld bytes) "
+                               "exceeded. $end\n", dump_limit);
+            return 0;
+      }
+
+      if (now != vcd_cur_time) {
+	    vcd_out_printf("#%" PLI_UINT64_FMT "\n", now);
+	    vcd_cur_time = now;
+      }
+
+	/* The records are in the order of the changes. Print them
+	 * last first as the value change callbacks would. */
+      for (idx = cause->index ; idx > 0 ; idx -= 1)
+	    show_this_record(rec + idx - 1);
+
+      return 0;
+}
+
 static PLI_INT32 dumpvars_cb(p_cb_data cause)
 {
       if (dumpvars_status != 1) return 0;
@@ -240,13 +314,13 @@ static PLI_INT32 dumpvars_cb(p_cb_data cause)
       dumpvars_time = timerec_to_time64(cause->time);
       vcd_cur_time = dumpvars_time;
 
-      fprintf(dump_file, "$enddefinitions $end\n");
+      vcd_out_printf("$enddefinitions $end\n");
 
       if (!dump_is_off) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", dumpvars_time);
-	    fprintf(dump_file, "$dumpvars\n");
+	    vcd_out_printf("#%" PLI_UINT64_FMT "\n", dumpvars_time);
+	    vcd_out_printf("$dumpvars\n");
 	    vcd_checkpoint();
-	    fprintf(dump_file, "$end\n");
+	    vcd_out_printf("$end\n");
       }
 
       return 0;
@@ -263,10 +337,11 @@ static PLI_INT32 finish_cb(p_cb_data cause)
       dumpvars_time = timerec_to_time64(cause->time);
 
       if (!dump_is_off && !dump_is_full && dumpvars_time != vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", dumpvars_time);
+	    vcd_out_printf("#%" PLI_UINT64_FMT "\n", dumpvars_time);
       }
 
-      fclose(dump_file);
+      vcd_out_close();
+      dump_file = 0;
 
       for (cur = vcd_list ;  cur ;  cur = next) {
 	    next = cur->next;
@@ -332,13 +407,13 @@ static PLI_INT32 sys_dumpoff_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       now64 = timerec_to_time64(&now);
 
       if (now64 > vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
+	    vcd_out_printf("#%" PLI_UINT64_FMT "\n", now64);
 	    vcd_cur_time = now64;
       }
 
-      fprintf(dump_file, "$dumpoff\n");
+      vcd_out_printf("$dumpoff\n");
       vcd_checkpoint_x();
-      fprintf(dump_file, "$end\n");
+      vcd_out_printf("$end\n");
 
       return 0;
 }
@@ -362,13 +437,13 @@ static PLI_INT32 sys_dumpon_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       now64 = timerec_to_time64(&now);
 
       if (now64 > vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
+	    vcd_out_printf("#%" PLI_UINT64_FMT "\n", now64);
 	    vcd_cur_time = now64;
       }
 
-      fprintf(dump_file, "$dumpon\n");
+      vcd_out_printf("$dumpon\n");
       vcd_checkpoint();
-      fprintf(dump_file, "$end\n");
+      vcd_out_printf("$end\n");
 
       return 0;
 }
@@ -389,13 +464,13 @@ static PLI_INT32 sys_dumpall_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       now64 = timerec_to_time64(&now);
 
       if (now64 > vcd_cur_time) {
-	    fprintf(dump_file, "#%" PLI_UINT64_FMT "\n", now64);
+	    vcd_out_printf("#%" PLI_UINT64_FMT "\n", now64);
 	    vcd_cur_time = now64;
       }
 
-      fprintf(dump_file, "$dumpall\n");
+      vcd_out_printf("$dumpall\n");
       vcd_checkpoint();
-      fprintf(dump_file, "$end\n");
+      vcd_out_printf("$end\n");
 
       return 0;
 }
@@ -421,6 +496,8 @@ static void open_dumpfile(vpiHandle callh)
 	    unsigned udx = 0;
 	    time_t walltime;
 
+	    vcd_out_open(dump_file);
+
 	    vpi_printf("VCD info: dumpfile %s opened for output.\n",
 	               dump_path);
 
@@ -436,15 +513,15 @@ static void open_dumpfile(vpiHandle callh)
 		  prec -= 1;
 	    }
 
-	    fprintf(dump_file, "$date\n");
-	    fprintf(dump_file, "\t%s",asctime(localtime(&walltime)));
-	    fprintf(dump_file, "$end\n");
-	    fprintf(dump_file, "$version\n");
-	    fprintf(dump_file, "\tIcarus Verilog\n");
-	    fprintf(dump_file, "$end\n");
-	    fprintf(dump_file, "$timescale\n");
-	    fprintf(dump_file, "\t%u%s\n", scale, units_names[udx]);
-	    fprintf(dump_file, "$end\n");
+	    vcd_out_printf("$date\n");
+	    vcd_out_printf("\t%s",asctime(localtime(&walltime)));
+	    vcd_out_printf("$end\n");
+	    vcd_out_printf("$version\n");
+	    vcd_out_printf("\tIcarus Verilog\n");
+	    vcd_out_printf("$end\n");
+	    vcd_out_printf("$timescale\n");
+	    vcd_out_printf("\t%u%s\n", scale, units_names[udx]);
+	    vcd_out_printf("$end\n");
       }
 }
 
@@ -486,7 +563,7 @@ static PLI_INT32 sys_dumpfile_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 static PLI_INT32 sys_dumpflush_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 {
       (void)name; /* Parameter is not used. */
-      if (dump_file) fflush(dump_file);
+      if (dump_file) vcd_out_flush();
 
       return 0;
 }
@@ -652,14 +729,21 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		  cb.user_data = (char*)info;
 		  cb.value     = NULL;
 		  cb.obj       = item;
-		  cb.reason    = cbValueChange;
-		  cb.cb_rtn    = variable_cb_1;
+		  cb.reason    = _cbValueRecord;
+		  cb.cb_rtn    = variable_record_cb;
 
 		  info->dmp_next = 0;
 		  info->next  = vcd_list;
 		  vcd_list    = info;
 
+		    /* Let the run time record the changes if it can,
+		     * otherwise get a callback for each change. */
 		  info->cb    = vpi_register_cb(&cb);
+		  if (info->cb == 0) {
+			cb.reason = cbValueChange;
+			cb.cb_rtn = variable_cb_1;
+			info->cb  = vpi_register_cb(&cb);
+		  }
 	    }
 
 	      /* Named events do not have a size, but other tools use
@@ -668,17 +752,17 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 	    if (item_type == vpiNamedEvent) size = 1;
 	    else size = vpi_get(vpiSize, item);
 
-	    fprintf(dump_file, "$var %s %u %s %s%s",
+	    vcd_out_printf("$var %s %u %s %s%s",
 		    type, size, ident, prefix, name);
 
 	      /* Add a range for vectored values. */
 	    if (size > 1 || vpi_get(vpiLeftRange, item) != 0) {
-		  fprintf(dump_file, " [%i:%i]",
+		  vcd_out_printf(" [%i:%i]",
 			  (int)vpi_get(vpiLeftRange, item),
 			  (int)vpi_get(vpiRightRange, item));
 	    }
 
-	    fprintf(dump_file, " $end\n");
+	    vcd_out_printf(" $end\n");
 	    break;
 
 	  case vpiModule:
@@ -719,7 +803,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		  }
 
 		  name = vpi_get_str(vpiName, item);
-		  fprintf(dump_file, "$scope %s %s $end\n", type, name);
+		  vcd_out_printf("$scope %s %s $end\n", type, name);
 
 		  for (i=0; types[i]>0; i++) {
 			vpiHandle hand;
@@ -730,7 +814,7 @@ static void scan_item(unsigned depth, vpiHandle item, int skip)
 		  }
 
 		    /* Sort any signals that we added above. */
-		  fprintf(dump_file, "$upscope $end\n");
+		  vcd_out_printf("$upscope $end\n");
 	    }
 	    break;
 
@@ -769,7 +853,7 @@ static int draw_scope(vpiHandle item, vpiHandle callh)
             assert(0);
       }
 
-      fprintf(dump_file, "$scope %s %s $end\n", type, name);
+      vcd_out_printf("$scope %s %s $end\n", type, name);
 
       return depth;
 }
@@ -862,7 +946,7 @@ static PLI_INT32 sys_dumpvars_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 	      /* The scope list must be sorted after we scan an item.  */
 	    vcd_names_sort(&vcd_tab);
 
-	    while (dep--) fprintf(dump_file, "$upscope $end\n");
+	    while (dep--) vcd_out_printf("$upscope $end\n");
 
 	      /* Add this signal to the variable list so we can verify it
 	       * is not included twice. This must be done after it has
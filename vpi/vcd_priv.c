@@ -47,6 +47,40 @@ int is_escaped_id(const char *name)
       return 1;
 }
 
+/*
+ * Format the vector of a value record as a vpiBinStrVal string would
+ * be, MSB first. The string is in a buffer that the next call reuses.
+ */
+char *vcd_record_to_str(const s_vpi_value_record*rec)
+{
+      static char *buf = 0;
+      static unsigned buf_size = 0;
+      unsigned size = (unsigned)rec->size;
+      unsigned idx;
+      char *cp;
+
+      if (size >= buf_size) {
+	    buf_size = size + 1;
+	    buf = realloc(buf, buf_size);
+      }
+
+      cp = buf + size;
+      *cp = 0;
+      for (idx = 0 ; idx < size ; idx += 32) {
+	    PLI_UINT32 aval = (PLI_UINT32)rec->value.vector[idx/32].aval;
+	    PLI_UINT32 bval = (PLI_UINT32)rec->value.vector[idx/32].bval;
+	    unsigned cnt = size - idx < 32 ? size - idx : 32;
+	    unsigned bit;
+	    for (bit = 0 ; bit < cnt ; bit += 1) {
+		  *--cp = "01zx"[(aval & 1) | ((bval & 1) << 1)];
+		  aval >>= 1;
+		  bval >>= 1;
+	    }
+      }
+
+      return buf;
+}
+
 struct stringheap_s name_heap = {0, 0};
 
 struct vcd_names_s {
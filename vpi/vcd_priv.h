@@ -29,6 +29,12 @@
 
 EXTERN int is_escaped_id(const char *name);
 
+/*
+ * Format the vector of a _cbValueRecord value record as a binary
+ * string, MSB first.
+ */
+EXTERN char *vcd_record_to_str(const s_vpi_value_record*rec);
+
 struct vcd_names_s;
 EXTERN struct stringheap_s name_heap;
 
@@ -126,6 +132,28 @@ EXTERN void vcd_work_dumpoff(void);
 EXTERN void vcd_work_emit_double(struct lxt2_wr_symbol*sym, double val);
 EXTERN void vcd_work_emit_bits(struct lxt2_wr_symbol*sym, const char*bits);
 
+/*
+ * The VCD dumper writes its file through the vcd_out_* functions. The
+ * output goes into one of a pair of buffers while a writer thread
+ * writes the other to the file, so the simulation only waits for the
+ * disk if it gets a whole buffer ahead. Most text is printed with
+ * vcd_out_printf, but the value changes are formatted directly into
+ * the buffer: vcd_out_reserve returns a place for at least len bytes,
+ * and vcd_out_commit adds the bytes actually used to the output.
+ * The vcd_out_bytes function returns the number of bytes output so
+ * far, whether or not they have reached the file yet.
+ */
+EXTERN void vcd_out_open(FILE*fd);
+EXTERN void vcd_out_printf(const char*fmt, ...)
+      __attribute__((format (printf,1,2)));
+EXTERN char*vcd_out_reserve(size_t len);
+EXTERN void vcd_out_commit(size_t len);
+EXTERN uint64_t vcd_out_bytes(void);
+  /* Write all the output so far to the file and fflush it. */
+EXTERN void vcd_out_flush(void);
+  /* Flush, stop the writer thread and close the file. */
+EXTERN void vcd_out_close(void);
+
 /* The compiletf routines are common for the VCD, LXT and LXT2 dumpers. */
 EXTERN PLI_INT32 sys_dumpvars_compiletf(ICARUS_VPI_CONST PLI_BYTE8 *name);
 
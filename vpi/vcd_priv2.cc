@@ -22,6 +22,8 @@
 # include  <set>
 # include  <string>
 # include  <pthread.h>
+# include  <cstdarg>
+# include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
 # include  <cassert>
@@ -283,3 +285,169 @@ extern "C" void vcd_work_terminate(void)
       unlock_item(true);
       pthread_join(work_thread, 0);
 }
+
+/*
+ * The VCD output buffers. The simulation thread fills the current
+ * buffer, and when it is full passes it to the writer thread as the
+ * pending buffer and carries on with the other one. Only the
+ * simulation thread sets vcd_out_pend, and it waits for the writer
+ * to clear it before it passes another buffer, so the writer is at
+ * most one buffer behind.
+ */
+static const size_t VCD_OUT_SIZE = 1024*1024;
+
+static FILE*vcd_out_file = 0;
+static pthread_t vcd_out_thread;
+static char*vcd_out_buf[2] = { 0, 0 };
+static size_t vcd_out_alloc[2] = { 0, 0 };
+static unsigned vcd_out_cur = 0;
+static size_t vcd_out_fill = 0;
+static uint64_t vcd_out_total = 0;
+
+static char*vcd_out_pend = 0;
+static size_t vcd_out_pend_len = 0;
+static bool vcd_out_stop = false;
+
+static pthread_mutex_t vcd_out_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  vcd_out_work_sig = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  vcd_out_idle_sig = PTHREAD_COND_INITIALIZER;
+
+static void* vcd_out_writer(void*)
+{
+      pthread_mutex_lock(&vcd_out_mutex);
+      for (;;) {
+	    while (vcd_out_pend == 0 && !vcd_out_stop)
+		  pthread_cond_wait(&vcd_out_work_sig, &vcd_out_mutex);
+	    if (vcd_out_pend == 0)
+		  break;
+
+	    char*buf = vcd_out_pend;
+	    size_t len = vcd_out_pend_len;
+	    pthread_mutex_unlock(&vcd_out_mutex);
+
+	    fwrite(buf, 1, len, vcd_out_file);
+
+	    pthread_mutex_lock(&vcd_out_mutex);
+	    vcd_out_pend = 0;
+	    pthread_cond_signal(&vcd_out_idle_sig);
+      }
+      pthread_mutex_unlock(&vcd_out_mutex);
+      return 0;
+}
+
+static void vcd_out_wait_idle(void)
+{
+      pthread_mutex_lock(&vcd_out_mutex);
+      while (vcd_out_pend)
+	    pthread_cond_wait(&vcd_out_idle_sig, &vcd_out_mutex);
+      pthread_mutex_unlock(&vcd_out_mutex);
+}
+
+/*
+ * Pass the current buffer to the writer thread and switch to the
+ * other one, which the writer is done with once it is idle.
+ */
+static void vcd_out_handoff(void)
+{
+      if (vcd_out_fill == 0)
+	    return;
+
+      pthread_mutex_lock(&vcd_out_mutex);
+      while (vcd_out_pend)
+	    pthread_cond_wait(&vcd_out_idle_sig, &vcd_out_mutex);
+      vcd_out_pend = vcd_out_buf[vcd_out_cur];
+      vcd_out_pend_len = vcd_out_fill;
+      pthread_cond_signal(&vcd_out_work_sig);
+      pthread_mutex_unlock(&vcd_out_mutex);
+
+      vcd_out_cur ^= 1;
+      vcd_out_fill = 0;
+}
+
+extern "C" void vcd_out_open(FILE*fd)
+{
+      assert(vcd_out_file == 0);
+      vcd_out_file = fd;
+      for (unsigned idx = 0 ; idx < 2 ; idx += 1) {
+	    vcd_out_buf[idx] = (char*)malloc(VCD_OUT_SIZE);
+	    vcd_out_alloc[idx] = VCD_OUT_SIZE;
+      }
+      vcd_out_cur = 0;
+      vcd_out_fill = 0;
+      vcd_out_total = 0;
+      vcd_out_stop = false;
+      pthread_create(&vcd_out_thread, 0, vcd_out_writer, 0);
+}
+
+extern "C" char*vcd_out_reserve(size_t len)
+{
+      if (vcd_out_fill + len > vcd_out_alloc[vcd_out_cur]) {
+	    vcd_out_handoff();
+	      // A single huge item may need a bigger buffer.
+	    if (len > vcd_out_alloc[vcd_out_cur]) {
+		  vcd_out_alloc[vcd_out_cur] = len;
+		  vcd_out_buf[vcd_out_cur] = (char*)realloc(vcd_out_buf[vcd_out_cur], len);
+	    }
+      }
+
+      return vcd_out_buf[vcd_out_cur] + vcd_out_fill;
+}
+
+extern "C" void vcd_out_commit(size_t len)
+{
+      assert(vcd_out_fill + len <= vcd_out_alloc[vcd_out_cur]);
+      vcd_out_fill += len;
+      vcd_out_total += len;
+}
+
+extern "C" void vcd_out_printf(const char*fmt, ...)
+{
+      va_list ap;
+      size_t room = vcd_out_alloc[vcd_out_cur] - vcd_out_fill;
+
+      va_start(ap, fmt);
+      int len = vsnprintf(vcd_out_buf[vcd_out_cur] + vcd_out_fill, room, fmt, ap);
+      va_end(ap);
+      assert(len >= 0);
+
+	// It did not fit, so make room and print it again.
+      if ((size_t)len >= room) {
+	    char*dst = vcd_out_reserve(len + 1);
+	    va_start(ap, fmt);
+	    vsnprintf(dst, len + 1, fmt, ap);
+	    va_end(ap);
+      }
+
+      vcd_out_commit(len);
+}
+
+extern "C" uint64_t vcd_out_bytes(void)
+{
+      return vcd_out_total;
+}
+
+extern "C" void vcd_out_flush(void)
+{
+      vcd_out_handoff();
+      vcd_out_wait_idle();
+      fflush(vcd_out_file);
+}
+
+extern "C" void vcd_out_close(void)
+{
+      vcd_out_flush();
+
+      pthread_mutex_lock(&vcd_out_mutex);
+      vcd_out_stop = true;
+      pthread_cond_signal(&vcd_out_work_sig);
+      pthread_mutex_unlock(&vcd_out_mutex);
+      pthread_join(vcd_out_thread, 0);
+
+      fclose(vcd_out_file);
+      vcd_out_file = 0;
+      for (unsigned idx = 0 ; idx < 2 ; idx += 1) {
+	    free(vcd_out_buf[idx]);
+	    vcd_out_buf[idx] = 0;
+	    vcd_out_alloc[idx] = 0;
+      }
+}
@@ -253,6 +253,58 @@ typedef struct t_vpi_delay  {
 #define vpiObjTypeVal  12
 #define vpiSuppressVal 13
 
+/*
+ * The _vpiRawVectorVal format is an Icarus Verilog extension for VPI
+ * applications that read or write wide vectors often. The value is
+ * passed through value.misc as a pointer to an s_vpi_raw_vector, and
+ * the aval/bval arrays hold (size+8*sizeof(unsigned long)-1) /
+ * (8*sizeof(unsigned long)) words in the same encoding as vpiVectorVal.
+ *
+ * vpi_get_value sets value.misc to point at a structure that is owned
+ * by the run time. Where it can, the run time points aval and bval at
+ * the words that hold the value of the object, so nothing is copied.
+ * The arrays are read only, the bits above size in the last word are
+ * undefined and the value they show is only good until control returns
+ * to the simulation. This format works for nets and variables.
+ *
+ * vpi_put_value takes a structure filled in by the caller, and the
+ * words are copied into the object without any conversion. A shorter
+ * value is zero extended and a longer value is truncated.
+ */
+#define _vpiRawVectorVal 0x1000001
+
+typedef struct t_vpi_raw_vector {
+      PLI_INT32 size; /* The width of the vector in bits. */
+      const unsigned long *aval;
+      const unsigned long *bval;
+} s_vpi_raw_vector, *p_vpi_raw_vector;
+
+/*
+ * The _vpiRawArrayVal format is an Icarus Verilog extension for loading
+ * and saving many words of a memory at once, as $readmemh and friends
+ * do. It is used with vpi_put_value and vpi_get_value on a vpiMemory
+ * handle, and value.misc points to an s_vpi_raw_array filled in by the
+ * caller. The count words start at array index index and go in order
+ * of increasing index. Each word takes the next (size+8*sizeof(unsigned
+ * long)-1) / (8*sizeof(unsigned long)) words of the aval and bval
+ * arrays, in the _vpiRawVectorVal encoding, and size must be the width
+ * of the memory words.
+ *
+ * vpi_put_value sets the words as if each had been put through its own
+ * word handle, but no handles are made and no values are converted.
+ * Only vpiNoDelay puts are supported. vpi_get_value fills in the aval
+ * and bval arrays, which the caller provides.
+ */
+#define _vpiRawArrayVal 0x1000002
+
+typedef struct t_vpi_raw_array {
+      PLI_INT32 index; /* The array index of the first word. */
+      PLI_INT32 count; /* The number of words. */
+      PLI_INT32 size;  /* The width of each word in bits. */
+      unsigned long *aval;
+      unsigned long *bval;
+} s_vpi_raw_array, *p_vpi_raw_array;
+
 
 /* SCALAR VALUES */
 #define vpi0 0
@@ -498,6 +550,41 @@ typedef struct t_cb_data {
 #define cbInteractiveScopeChange 23
 #define cbUnresolvedSystf   24
 #define cbAtEndOfSimTime    31
+/* IVL private callback reasons */
+#define _cbValueRecord      0x1000000
+
+/*
+ * The _cbValueRecord callback is an Icarus Verilog extension for VPI
+ * applications that follow many signals, such as the waveform dumpers
+ * and co-simulation or coverage libraries. It is placed on an object
+ * like a cbValueChange callback, but the routine is not called for
+ * each change. Instead the run time notes which objects changed, and
+ * at the read only synch time of the time step passes them all to the
+ * callback routine in a single call. In that call the cb_data index
+ * is the number of changed objects, the time is the simulation time
+ * and the value has the _vpiRecordVal format with value.misc pointing
+ * at an array of s_vpi_value_record, one for each object, in the order
+ * that they first changed. The obj and user_data of each record are
+ * those given when the callback was registered. Vectors are given in
+ * the vpiVectorVal form, and the records and vectors are only valid
+ * during the call. Objects with different callback routines are
+ * passed in separate calls, so use one routine to get one call.
+ *
+ * Nets, variables, real variables and the constant words of variable
+ * arrays can be recorded. The run time returns a nil handle for other
+ * objects, so the caller can fall back to a cbValueChange callback.
+ */
+#define _vpiRecordVal       0x1000000
+
+typedef struct t_vpi_value_record {
+      vpiHandle obj;
+      ICARUS_VPI_CONST PLI_BYTE8 *user_data;
+      PLI_INT32 size; /* The vector width, or 0 for a real value. */
+      union {
+	    p_vpi_vecval vector;
+	    double real;
+      } value;
+} s_vpi_value_record, *p_vpi_value_record;
 
 extern vpiHandle vpi_register_cb(p_cb_data data);
 extern PLI_INT32 vpi_remove_cb(vpiHandle ref);
@@ -19,6 +19,7 @@
 
 # include  "arith.h"
 # include  "schedule.h"
+# include  "statistics.h"
 # include  <climits>
 # include  <iostream>
 # include  <cassert>
@@ -28,7 +29,7 @@
 using namespace std;
 
 vvp_arith_::vvp_arith_(unsigned wid)
-: wid_(wid), op_a_(wid), op_b_(wid), x_val_(wid)
+: wid_(wid), has_run_(false), op_a_(wid), op_b_(wid), x_val_(wid)
 {
       for (unsigned idx = 0 ;  idx < wid ;  idx += 1) {
 	    op_a_ .set_bit(idx, BIT4_Z);
@@ -37,20 +38,31 @@ vvp_arith_::vvp_arith_(unsigned wid)
       }
 }
 
-void vvp_arith_::dispatch_operand_(vvp_net_ptr_t ptr, const vvp_vector4_t&bit)
+bool vvp_arith_::dispatch_operand_(vvp_net_ptr_t ptr, const vvp_vector4_t&bit)
 {
       unsigned port = ptr.port();
+      vvp_vector4_t*op = 0;
       switch (port) {
 	  case 0:
-	    op_a_ = bit;
+	    op = &op_a_;
 	    break;
 	  case 1:
-	    op_b_ = bit;
+	    op = &op_b_;
 	    break;
 	  default:
 	    fprintf(stderr, "Unsupported port type %u.\n", port);
 	    assert(0);
       }
+
+      count_vec4_checked += 1;
+      if (has_run_ && op->eeq(bit)) {
+	    count_vec4_suppressed += 1;
+	    return false;
+      }
+
+      *op = bit;
+      has_run_ = true;
+      return true;
 }
 
 void vvp_arith_::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
@@ -216,7 +228,8 @@ void vvp_arith_div::wide4_(vvp_net_ptr_t ptr)
 void vvp_arith_div::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                               vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       if (wid_ > 8 * sizeof(unsigned long)) {
 	    wide4_(ptr);
@@ -329,7 +342,8 @@ void vvp_arith_mod::wide_(vvp_net_ptr_t ptr)
 void vvp_arith_mod::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                               vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       if (wid_ > 8 * sizeof(unsigned long)) {
 	    wide_(ptr);
@@ -430,7 +444,8 @@ void vvp_arith_mult::wide_(vvp_net_ptr_t ptr)
 void vvp_arith_mult::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                                vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       if (wid_ > 8 * sizeof(int64_t)) {
 	    wide_(ptr);
@@ -480,7 +495,8 @@ vvp_arith_pow::~vvp_arith_pow()
 void vvp_arith_pow::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                               vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       vvp_vector2_t a2 (op_a_, true);
       vvp_vector2_t b2 (op_b_, true);
@@ -530,7 +546,8 @@ vvp_arith_sum::~vvp_arith_sum()
 void vvp_arith_sum::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                               vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       vvp_net_t*net = ptr.ptr();
 
@@ -575,7 +592,8 @@ vvp_arith_sub::~vvp_arith_sub()
 void vvp_arith_sub::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                               vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       vvp_net_t*net = ptr.ptr();
 
@@ -610,7 +628,8 @@ vvp_cmp_eeq::vvp_cmp_eeq(unsigned wid)
 void vvp_cmp_eeq::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                             vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       vvp_vector4_t eeq (1);
       eeq.set_bit(0, BIT4_1);
@@ -635,7 +654,8 @@ vvp_cmp_nee::vvp_cmp_nee(unsigned wid)
 void vvp_cmp_nee::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                             vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       vvp_vector4_t eeq (1);
       eeq.set_bit(0, BIT4_0);
@@ -666,7 +686,8 @@ vvp_cmp_eq::vvp_cmp_eq(unsigned wid)
 void vvp_cmp_eq::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                            vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       if (op_a_.size() != op_b_.size()) {
 	    cerr << "COMPARISON size mismatch. "
@@ -713,7 +734,8 @@ vvp_cmp_eqx::vvp_cmp_eqx(unsigned wid)
 void vvp_cmp_eqx::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                            vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       if (op_a_.size() != op_b_.size()) {
 	    cerr << "COMPARISON size mismatch. "
@@ -750,7 +772,8 @@ vvp_cmp_eqz::vvp_cmp_eqz(unsigned wid)
 void vvp_cmp_eqz::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                            vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       if (op_a_.size() != op_b_.size()) {
 	    cerr << "COMPARISON size mismatch. "
@@ -791,7 +814,8 @@ vvp_cmp_ne::vvp_cmp_ne(unsigned wid)
 void vvp_cmp_ne::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                            vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       if (op_a_.size() != op_b_.size()) {
 	    cerr << "internal error: vvp_cmp_ne: op_a_=" << op_a_
@@ -835,7 +859,8 @@ void vvp_cmp_gtge_base_::recv_vec4_base_(vvp_net_ptr_t ptr,
 					 const vvp_vector4_t&bit,
 					 vvp_bit4_t out_if_equal)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       vvp_bit4_t out = signed_flag_
 	    ? compare_gtge_signed(op_a_, op_b_, out_if_equal)
@@ -878,7 +903,8 @@ vvp_cmp_weq::vvp_cmp_weq(unsigned wid)
 void vvp_cmp_weq::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                             vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       vvp_vector4_t eeq (1);
       eeq.set_bit(0, BIT4_1);
@@ -913,7 +939,8 @@ vvp_cmp_wne::vvp_cmp_wne(unsigned wid)
 void vvp_cmp_wne::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                             vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       vvp_vector4_t eeq (1);
       eeq.set_bit(0, BIT4_0);
@@ -953,7 +980,8 @@ vvp_shiftl::~vvp_shiftl()
 void vvp_shiftl::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                            vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       vvp_vector4_t out (op_a_.size());
 
@@ -988,7 +1016,8 @@ vvp_shiftr::~vvp_shiftr()
 void vvp_shiftr::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                            vvp_context_t)
 {
-      dispatch_operand_(ptr, bit);
+      if (! dispatch_operand_(ptr, bit))
+	    return;
 
       vvp_vector4_t out (op_a_.size());
 
@@ -42,10 +42,14 @@ class vvp_arith_  : public vvp_net_fun_t {
                         vvp_context_t ctx);
 
     protected:
-      void dispatch_operand_(vvp_net_ptr_t ptr, const vvp_vector4_t&bit);
+	// Save the operand, and return false if it is the same as the
+	// operand that the functor last ran with. The result is then
+	// unchanged, so there is no need to compute and send it again.
+      bool dispatch_operand_(vvp_net_ptr_t ptr, const vvp_vector4_t&bit);
 
     protected:
       unsigned wid_;
+      bool has_run_;
 
       vvp_vector4_t op_a_;
       vvp_vector4_t op_b_;
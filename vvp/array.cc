@@ -287,6 +287,103 @@ char* __vpiArray::vpi_get_str(int code)
       return generic_get_str(code, scope, name, NULL);
 }
 
+/*
+ * Check the s_vpi_raw_array of a _vpiRawArrayVal value against this
+ * array and return the canonical address of the first word, or -1 if
+ * it does not fit.
+ */
+long __vpiArray::raw_array_address(const s_vpi_raw_array*raw)
+{
+      if (raw == 0 || raw->count < 0) {
+	    fprintf(stderr, "VPI error: invalid _vpiRawArrayVal value "
+		    "for array %s.\n", name);
+	    return -1;
+      }
+
+      if (raw->size != get_word_size()) {
+	    fprintf(stderr, "VPI error: _vpiRawArrayVal word size %d "
+		    "does not match the %d bit words of array %s.\n",
+		    (int)raw->size, get_word_size(), name);
+	    return -1;
+      }
+
+      long address = (long)raw->index - first_addr.get_value();
+      if (address < 0 || address + raw->count > (long)get_size()) {
+	    fprintf(stderr, "VPI error: _vpiRawArrayVal words [%d+:%d] "
+		    "are outside array %s.\n", (int)raw->index,
+		    (int)raw->count, name);
+	    return -1;
+      }
+
+      return address;
+}
+
+/*
+ * A whole array only has a value in the _vpiRawArrayVal format. The
+ * words of a net array are read through their own handles.
+ */
+void __vpiArray::vpi_get_value(p_vpi_value vp)
+{
+      if (vp->format != _vpiRawArrayVal) {
+	    fprintf(stderr, "vpi sorry: format is not implemented\n");
+	    return;
+      }
+
+      s_vpi_raw_array*raw = reinterpret_cast<s_vpi_raw_array*>(vp->value.misc);
+      long address = raw_array_address(raw);
+      if (address < 0)
+	    return;
+
+      if (nets == 0) {
+	    get_words(address, raw->count, raw->aval, raw->bval);
+	    return;
+      }
+
+      unsigned cnt = (raw->size + 8*sizeof(unsigned long) - 1)
+		   / (8*sizeof(unsigned long));
+      for (int idx = 0 ; idx < raw->count ; idx += 1) {
+	    s_vpi_value word_val;
+	    word_val.format = _vpiRawVectorVal;
+	    nets[address + idx]->vpi_get_value(&word_val);
+	    const s_vpi_raw_vector*word = reinterpret_cast<s_vpi_raw_vector*>
+		  (word_val.value.misc);
+	    memcpy(raw->aval + idx*cnt, word->aval, cnt*sizeof(unsigned long));
+	    memcpy(raw->bval + idx*cnt, word->bval, cnt*sizeof(unsigned long));
+      }
+}
+
+vpiHandle __vpiArray::vpi_put_value(p_vpi_value vp, int flags)
+{
+      if (vp->format != _vpiRawArrayVal) {
+	    fprintf(stderr, "vpi sorry: format is not implemented\n");
+	    return 0;
+      }
+
+      const s_vpi_raw_array*raw = reinterpret_cast<s_vpi_raw_array*>(vp->value.misc);
+      long address = raw_array_address(raw);
+      if (address < 0)
+	    return 0;
+
+      if (nets == 0) {
+	    set_words(address, raw->count, raw->aval, raw->bval);
+	    return 0;
+      }
+
+      unsigned cnt = (raw->size + 8*sizeof(unsigned long) - 1)
+		   / (8*sizeof(unsigned long));
+      for (int idx = 0 ; idx < raw->count ; idx += 1) {
+	    s_vpi_raw_vector word;
+	    word.size = raw->size;
+	    word.aval = raw->aval + idx*cnt;
+	    word.bval = raw->bval + idx*cnt;
+	    s_vpi_value word_val;
+	    word_val.format = _vpiRawVectorVal;
+	    word_val.value.misc = reinterpret_cast<PLI_BYTE8*>(&word);
+	    nets[address + idx]->vpi_put_value(&word_val, flags);
+      }
+      return 0;
+}
+
 vpiHandle __vpiArray::vpi_handle(int code)
 {
       switch (code) {
@@ -704,6 +801,62 @@ vvp_vector4_t __vpiArray::get_word(unsigned address)
       return val;
 }
 
+/*
+ * Set count words starting at the canonical address from raw word
+ * arrays, as for vvp_vector4array_t::set_words(). The words of a
+ * vvp_vector4_t array are copied straight into the storage, other
+ * variable arrays get them through set_word(). Every word is still
+ * reported as changed, so array ports and callbacks see the same as
+ * for single word puts.
+ */
+void __vpiArray::set_words(unsigned address, unsigned count,
+			   const unsigned long*abits, const unsigned long*bbits)
+{
+      assert(nets == 0);
+      assert(address + count <= get_size());
+
+      if (vals4) {
+	    vals4->set_words(address, count, abits, bbits);
+      } else {
+	    unsigned cnt = (vals_width + 8*sizeof(unsigned long) - 1)
+			 / (8*sizeof(unsigned long));
+	    vvp_vector4_t tmp (vals_width);
+	    for (unsigned idx = 0 ; idx < count ; idx += 1) {
+		  tmp.set_words(abits + idx*cnt, bbits + idx*cnt);
+		  vals->set_word(address + idx, tmp);
+	    }
+      }
+
+      if (ports_ == 0 && vpi_callbacks == 0)
+	    return;
+
+      for (unsigned idx = 0 ; idx < count ; idx += 1)
+	    word_change(address + idx);
+}
+
+void __vpiArray::get_words(unsigned address, unsigned count,
+			   unsigned long*abits, unsigned long*bbits)
+{
+      assert(nets == 0);
+      assert(address + count <= get_size());
+
+      if (vals4) {
+	    vals4->get_words(address, count, abits, bbits);
+	    return;
+      }
+
+      unsigned cnt = (vals_width + 8*sizeof(unsigned long) - 1)
+		   / (8*sizeof(unsigned long));
+      for (unsigned idx = 0 ; idx < count ; idx += 1) {
+	    vvp_vector4_t tmp;
+	    vals->get_word(address + idx, tmp);
+	    const unsigned long*ap, *bp;
+	    tmp.get_words(ap, bp);
+	    memcpy(abits + idx*cnt, ap, cnt*sizeof(unsigned long));
+	    memcpy(bbits + idx*cnt, bp, cnt*sizeof(unsigned long));
+      }
+}
+
 double __vpiArray::get_word_r(unsigned address)
 {
       if (vals) {
@@ -1482,6 +1635,80 @@ value_callback*vpip_array_word_change(p_cb_data data)
       return cbh;
 }
 
+/*
+ * The value record callback (_cbValueRecord) of a word of a variable
+ * array. It sits in the callback list of the array like any other
+ * word callback, so that word_change() finds it.
+ */
+class array_word_record_callback : public array_word_value_callback,
+				   public value_record_source {
+    public:
+      array_word_record_callback(p_cb_data data, __vpiArray*array,
+				 unsigned wid);
+
+      bool test_value_callback_ready(void);
+      void get_vec4(vvp_vector4_t&val);
+      double get_real(void);
+
+    private:
+      __vpiArray*array_;
+};
+
+array_word_record_callback::array_word_record_callback(p_cb_data data,
+						       __vpiArray*array,
+						       unsigned w)
+: array_word_value_callback(data), value_record_source(this, w),
+  array_(array)
+{
+}
+
+bool array_word_record_callback::test_value_callback_ready(void)
+{
+      queue();
+      return false;
+}
+
+void array_word_record_callback::get_vec4(vvp_vector4_t&val)
+{
+      val = array_->vals4->get_word(word_addr);
+}
+
+double array_word_record_callback::get_real(void)
+{
+      double val = 0.0;
+      if ((unsigned long)word_addr < array_->vals->get_size())
+	    array_->vals->get_word(word_addr, val);
+      return val;
+}
+
+/*
+ * Make a value record callback for a constant word of a variable
+ * array, or return nil if that is not what the object is.
+ */
+value_callback* vpip_array_word_record(p_cb_data data)
+{
+      struct __vpiArrayWord*word = array_var_word_from_handle(data->obj);
+      if (word == 0)
+	    return 0;
+
+      __vpiArray*parent = static_cast<__vpiArray*>(word->get_parent());
+      unsigned wid;
+      if (parent->vals4)
+	    wid = parent->vals_width;
+      else if (vpi_array_is_real(parent))
+	    wid = 0;
+      else
+	    return 0;
+
+      array_word_record_callback*cbh
+	    = new array_word_record_callback(data, parent, wid);
+      cbh->word_addr = word->get_index();
+      cbh->next = parent->vpi_callbacks;
+      parent->vpi_callbacks = cbh;
+
+      return cbh;
+}
+
 value_callback* vpip_array_change(p_cb_data data)
 {
       array_word_value_callback*cbh = new array_word_value_callback(data);
@@ -34,6 +34,7 @@ extern vvp_array_t array_find(const char*label);
 /* VPI hooks */
 extern value_callback* vpip_array_word_change(p_cb_data data);
 extern value_callback* vpip_array_change(p_cb_data data);
+extern value_callback* vpip_array_word_record(p_cb_data data);
 
 /* Compile hooks */
 extern void compile_varw_real(char*label, vvp_array_t array,
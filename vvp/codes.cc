@@ -96,6 +96,53 @@ vvp_code_t codespace_null(void)
       return first_chunk + 0;
 }
 
+#ifdef USE_SUPERINSTRUCTIONS
+/*
+ * Test if the instruction at idx within the chunk has the given
+ * opcode. Only the first fill instructions of the chunk are valid,
+ * and the CHUNK_LINK at the end is never included, so a sequence that
+ * crosses chunks never matches.
+ */
+static inline bool code_is(vvp_code_t chunk, unsigned fill, unsigned idx,
+			   vvp_code_fun fun)
+{
+      return idx < fill && chunk[idx].opcode == fun;
+}
+#endif
+
+void codespace_fuse(void)
+{
+#ifdef USE_SUPERINSTRUCTIONS
+      for (vvp_code_t chunk = first_chunk ; chunk ; chunk = chunk[code_chunk_size-1].cptr) {
+	    unsigned fill = code_chunk_size-1;
+	    if (chunk == current_chunk)
+		  fill = current_within_chunk;
+
+	    for (unsigned idx = 0 ; idx < fill ; idx += 1) {
+		  vvp_code_t cp = chunk + idx;
+
+		  if (cp->opcode == &of_LOAD_VEC4
+		      && code_is(chunk, fill, idx+1, &of_CMPIE)
+		      && code_is(chunk, fill, idx+2, &of_JMP0XZ)) {
+			cp->opcode = &of_LOAD_VEC4_CMPIE_JMP0XZ;
+			count_opcodes_fused += 1;
+
+		  } else if (cp->opcode == &of_LOAD_VEC4
+			     && code_is(chunk, fill, idx+1, &of_FLAG_SET_VEC4)
+			     && code_is(chunk, fill, idx+2, &of_JMP0XZ)) {
+			cp->opcode = &of_LOAD_VEC4_FLAG_JMP0XZ;
+			count_opcodes_fused += 1;
+
+		  } else if (cp->opcode == &of_CMPIE
+			     && code_is(chunk, fill, idx+1, &of_JMP0XZ)) {
+			cp->opcode = &of_CMPIE_JMP0XZ;
+			count_opcodes_fused += 1;
+		  }
+	    }
+      }
+#endif
+}
+
 #ifdef CHECK_WITH_VALGRIND
 void codespace_delete(void)
 {
@@ -280,6 +280,15 @@ extern bool of_REAP_UFUNC(vthread_t thr, vvp_code_t code);
 
 extern bool of_CHUNK_LINK(vthread_t thr, vvp_code_t code);
 
+/*
+ * These are fused (super) instructions that replace the first opcode
+ * of common instruction sequences. They are not part of the assembly
+ * language, but are substituted by codespace_fuse().
+ */
+extern bool of_CMPIE_JMP0XZ(vthread_t thr, vvp_code_t code);
+extern bool of_LOAD_VEC4_CMPIE_JMP0XZ(vthread_t thr, vvp_code_t code);
+extern bool of_LOAD_VEC4_FLAG_JMP0XZ(vthread_t thr, vvp_code_t code);
+
 /*
  * This is the format of a machine code instruction.
  */
@@ -322,4 +331,13 @@ extern vvp_code_t codespace_allocate(void);
 extern vvp_code_t codespace_next(void);
 extern vvp_code_t codespace_null(void);
 
+/*
+ * Scan the code space and replace the first opcode of common
+ * instruction sequences with a fused instruction that executes the
+ * entire sequence. The following instructions are left in place, so
+ * branches into the middle of a sequence still work. This is called
+ * once after the code is loaded.
+ */
+extern void codespace_fuse(void);
+
 #endif /* IVL_codes_H */
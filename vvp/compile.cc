@@ -34,6 +34,8 @@
 # include  "schedule.h"
 # include  <iostream>
 # include  <list>
+# include  <map>
+# include  <vector>
 # include  <cstdlib>
 # include  <cstring>
 # include  <cassert>
@@ -375,6 +377,7 @@ void define_functor_symbol(const char*label, vvp_net_t*net)
       symbol_value_t val;
       val.net = net;
       sym_set_value(sym_functors, label, val);
+      resolv_wake(label);
 }
 
 static vvp_net_t*lookup_functor_symbol(const char*label)
@@ -479,9 +482,28 @@ vvp_net_t* vvp_net_lookup(const char*label)
  * The mes parameter of the resolve method tells the resolver that
  * this call is its last chance. If it cannot complete the operation,
  * it must print an error message and return false.
+ *
+ * The compile_cleanup function tries the whole resolv_list once. A
+ * reference that still fails is waiting for a label that some other
+ * resolve action will define, so it is put on the waiter list for its
+ * label in resolv_waiters. Defining a functor or VPI symbol wakes the
+ * waiters for that label, and they are tried again once the first
+ * pass is done. So no reference is retried unless its label changed.
+ *
+ * The order that the references are resolved in sets the order of the
+ * fan-out links, and so the order of events, so it must stay the same
+ * as when the whole list was tried over and over. Each of those passes
+ * went over the references that were left in the order opposite to
+ * the pass before. The woken references are kept in resolv_ready by
+ * their place in the first pass, and are taken in the order that the
+ * passes would have reached them.
  */
 static resolv_list_s*resolv_list = 0;
 
+static symbol_map_s<resolv_list_s>*resolv_waiters = 0;
+static std::vector<char*> resolv_wait_labels;
+static std::map<unsigned long,resolv_list_s*> resolv_ready;
+
 resolv_list_s::~resolv_list_s()
 {
       free(label_);
@@ -498,6 +520,33 @@ void resolv_submit(resolv_list_s*cur)
       resolv_list = cur;
 }
 
+void resolv_wait(resolv_list_s*cur)
+{
+      resolv_list_s*head = resolv_waiters->sym_get_value(cur->label());
+      if (head == 0) {
+	    resolv_wait_labels.push_back(strdup(cur->label()));
+      }
+      cur->next = head;
+      resolv_waiters->sym_set_value(cur->label(), cur);
+      count_resolv_waits += 1;
+}
+
+void resolv_wake(const char*label)
+{
+      if (resolv_waiters == 0)
+	    return;
+
+      resolv_list_s*head = resolv_waiters->sym_get_value(label);
+      if (head == 0)
+	    return;
+
+      resolv_waiters->sym_set_value(label, 0);
+      while (head) {
+	    resolv_ready[head->seq_] = head;
+	    head = head->next;
+      }
+}
+
 
 /*
  * Look up vvp_nets in the symbol table. The "source" is the label for
@@ -770,39 +819,103 @@ void compile_compiletf(struct __vpiSysTaskCall*obj)
 
 void compile_cleanup(void)
 {
-      int lnerrs = -1;
       int nerrs = 0;
-      int last;
+
+      load_clock_lap();
 
       if (verbose_flag) {
 	    fprintf(stderr, " ... Linking\n");
 	    fflush(stderr);
       }
 
-      do {
-	    resolv_list_s *res = resolv_list;
-	    resolv_list = 0x0;
-	    last = nerrs == lnerrs;
-	    lnerrs = nerrs;
-	    nerrs = 0;
+      resolv_waiters = new symbol_map_s<resolv_list_s>;
+
+      resolv_list_s *res = resolv_list;
+      resolv_list = 0x0;
+      unsigned long seq = 0;
+      while (res) {
+	    resolv_list_s *cur = res;
+	    res = res->next;
+	    cur->seq_ = seq++;
+	    count_resolv_deferred += 1;
+	    if (cur->resolve())
+		  delete cur;
+	    else
+		  resolv_wait(cur);
+      }
+
+	/* Try the references whose labels were defined since they
+	   started waiting. Those can define labels in turn. A woken
+	   reference that the current pass has not yet reached is taken
+	   in this pass, and the rest in the next pass, which goes the
+	   other way. The pass after the first goes down. */
+      bool up = false, last_up = true;
+      unsigned long at = seq;
+      while (! resolv_ready.empty()) {
+	    std::map<unsigned long,resolv_list_s*>::iterator cur_it;
+	    if (up) {
+		  cur_it = resolv_ready.upper_bound(at);
+		  if (cur_it == resolv_ready.end()) {
+			up = false;
+			at = seq;
+			continue;
+		  }
+	    } else {
+		  cur_it = resolv_ready.lower_bound(at);
+		  if (cur_it == resolv_ready.begin()) {
+			up = true;
+			cur_it = resolv_ready.begin();
+		  } else {
+			--cur_it;
+		  }
+	    }
+
+	    resolv_list_s *cur = cur_it->second;
+	    resolv_ready.erase(cur_it);
+	    at = cur->seq_;
+	    last_up = up;
+	    if (cur->resolve())
+		  delete cur;
+	    else
+		  resolv_wait(cur);
+      }
+
+	/* Anything still waiting cannot be resolved. Give each a last
+	   chance, which prints the error message, in the order of the
+	   pass that would have found that nothing changed. */
+      symbol_map_s<resolv_list_s>*waiters = resolv_waiters;
+      resolv_waiters = 0;
+      for (size_t idx = 0 ; idx < resolv_wait_labels.size() ; idx += 1) {
+	    res = waiters->sym_get_value(resolv_wait_labels[idx]);
 	    while (res) {
-		  resolv_list_s *cur = res;
+		  resolv_ready[res->seq_] = res;
 		  res = res->next;
-		  if (cur->resolve(last))
-			delete cur;
-		  else {
-			nerrs++;
-			cur->next = resolv_list;
-			resolv_list = cur;
-		  }
 	    }
-	    if (nerrs && last)
-		  fprintf(stderr,
-			  "compile_cleanup: %d unresolved items\n",
-			  nerrs);
-      } while (nerrs && !last);
+	    free(resolv_wait_labels[idx]);
+      }
+      resolv_wait_labels.clear();
+      delete waiters;
+
+      while (! resolv_ready.empty()) {
+	    std::map<unsigned long,resolv_list_s*>::iterator cur_it;
+	    if (last_up) {
+		  cur_it = resolv_ready.begin();
+	    } else {
+		  cur_it = resolv_ready.end();
+		  --cur_it;
+	    }
+	    resolv_list_s *cur = cur_it->second;
+	    resolv_ready.erase(cur_it);
+	    if (! cur->resolve(true))
+		  nerrs++;
+	    delete cur;
+      }
+
+      if (nerrs)
+	    fprintf(stderr, "compile_cleanup: %d unresolved items\n", nerrs);
 
       compile_errors += nerrs;
+      time_load_link = load_clock_lap();
 
       if (verbose_flag) {
 	    fprintf(stderr, " ... Removing symbol tables\n");
@@ -824,10 +937,14 @@ void compile_cleanup(void)
       sym_functors = 0;
 
       delete_udp_symbols();
+      time_load_symbols = load_clock_lap();
 
       compile_island_cleanup();
       compile_array_cleanup();
 
+      codespace_fuse();
+      time_load_finish = load_clock_lap();
+
       if (verbose_flag) {
 	    fprintf(stderr, " ... Compiletf functions\n");
 	    fflush(stderr);
@@ -845,6 +962,7 @@ void compile_cleanup(void)
       }
 
       vpi_mode_flag = VPI_MODE_NONE;
+      time_load_compiletf = load_clock_lap();
 }
 
 void compile_vpi_symbol(const char*label, vpiHandle obj)
@@ -852,6 +970,7 @@ void compile_vpi_symbol(const char*label, vpiHandle obj)
       symbol_value_t val;
       val.ptr = obj;
       sym_set_value(sym_vpi, label, val);
+      resolv_wake(label);
 }
 
 /*
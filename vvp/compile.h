@@ -314,6 +314,7 @@ class resolv_list_s {
     public:
       explicit resolv_list_s(char*lab) : label_(lab) {
 	    next = NULL;
+	    seq_ = 0;
       }
       virtual ~resolv_list_s();
       virtual bool resolve(bool mes = false) = 0;
@@ -323,12 +324,22 @@ class resolv_list_s {
 
     private:
       friend void resolv_submit(class resolv_list_s*cur);
+      friend void resolv_wait(class resolv_list_s*cur);
+      friend void resolv_wake(const char*label);
       friend void compile_cleanup(void);
 
       char*label_;
       class resolv_list_s*next;
+	// The place of the action in the first linking pass.
+      unsigned long seq_;
 };
 
+/*
+ * A symbol that is defined while compile_cleanup links the design
+ * wakes the resolve actions that are waiting for its label.
+ */
+extern void resolv_wake(const char*label);
+
 /*
  * This function schedules a lookup of an indexed label. The ref
  * points to the vvp_net_t that receives the result. The result may
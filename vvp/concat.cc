@@ -19,6 +19,7 @@
 
 # include  "compile.h"
 # include  "vvp_net.h"
+# include  "statistics.h"
 # include  <cstdlib>
 # include  <iostream>
 # include  <cassert>
@@ -27,7 +28,7 @@ using namespace std;
 
 vvp_fun_concat::vvp_fun_concat(unsigned w0, unsigned w1,
 			       unsigned w2, unsigned w3)
-: val_(w0+w1+w2+w3)
+: has_run_(false), val_(w0+w1+w2+w3)
 {
       wid_[0] = w0;
       wid_[1] = w1;
@@ -58,10 +59,15 @@ void vvp_fun_concat::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
       for (unsigned idx = 0 ;  idx < pdx ;  idx += 1)
 	    off += wid_[idx];
 
-      for (unsigned idx = 0 ;  idx < wid_[pdx] ;  idx += 1) {
-	    val_.set_bit(off+idx, bit.value(idx));
+	// If this input did not change, then neither did the output,
+	// unless this is the first time through.
+      count_vec4_checked += 1;
+      if (! val_.set_vec(off, bit) && has_run_) {
+	    count_vec4_suppressed += 1;
+	    return;
       }
 
+      has_run_ = true;
       port.ptr()->send_vec4(val_, 0);
 }
 
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * This is a micro-benchmark for the decimal conversions in
+ * vec4_decimal.cc. For a range of widths it converts random values
+ * to decimal and back, checks that the round trip and a simple bit
+ * at a time reference agree, and prints the time per call in
+ * microseconds. It is built and run by "make bench".
+ */
+
+# include  "vec4_decimal.h"
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <ctime>
+# include  <string>
+# include  <vector>
+
+using namespace std;
+
+static const unsigned BITS_PER_WORD = 8*sizeof(unsigned long);
+
+/* Each measurement repeats the call for at least this long. */
+static const double MIN_SECONDS = 0.2;
+
+static unsigned long random_word(void)
+{
+      unsigned long res = 0;
+      for (unsigned idx = 0 ; idx < sizeof(unsigned long) ; idx += 1)
+	    res = (res << 8) | (rand() & 0xff);
+      return res;
+}
+
+/*
+ * The reference conversion shifts the value into a base 10^4 number
+ * a bit at a time, the way the decimal conversion used to be done.
+ */
+static string reference_to_dec(const vector<unsigned long>&val, unsigned width)
+{
+      vector<unsigned> digs (width/13 + 2, 0);
+      for (unsigned idx = width ; idx > 0 ; idx -= 1) {
+	    unsigned carry = (val[(idx-1)/BITS_PER_WORD]
+			      >> ((idx-1)%BITS_PER_WORD)) & 1;
+	    for (unsigned jdx = 0 ; jdx < digs.size() ; jdx += 1) {
+		  unsigned tmp = digs[jdx]*2 + carry;
+		  digs[jdx] = tmp % 10000;
+		  carry = tmp / 10000;
+	    }
+      }
+
+      string res;
+      char tmp[8];
+      for (unsigned idx = digs.size() ; idx > 0 ; idx -= 1) {
+	    if (res.empty() && digs[idx-1] == 0)
+		  continue;
+	    snprintf(tmp, sizeof tmp, res.empty()? "%u" : "%04u", digs[idx-1]);
+	    res += tmp;
+      }
+      return res.empty()? string("0") : res;
+}
+
+struct timer_s {
+      clock_t start;
+      unsigned long calls;
+      timer_s() : start(clock()), calls(0) { }
+      bool more() const
+      { return (double)(clock() - start) / CLOCKS_PER_SEC < MIN_SECONDS; }
+      double usec_per_call() const
+      { return (double)(clock() - start) / CLOCKS_PER_SEC * 1e6 / calls; }
+};
+
+int main(int, char*[])
+{
+      int errors = 0;
+      srand(1);
+
+      printf("%6s %12s %12s %12s  (us/call)\n",
+	     "width", "to_dec", "from_dec", "bit_serial");
+
+      for (unsigned width = 8 ; width <= 65536 ; width *= 2) {
+	    unsigned words = (width + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	    vector<unsigned long> val (words);
+	    for (unsigned idx = 0 ; idx < words ; idx += 1)
+		  val[idx] = random_word();
+	    if (width % BITS_PER_WORD)
+		  val[words-1] &= (1UL << (width % BITS_PER_WORD)) - 1;
+
+	    vector<char> buf (width*31/100 + 2);
+	    vector<unsigned long> tmp (words);
+
+	      // Check the conversion both ways against the reference.
+	    tmp = val;
+	    unsigned ndigits = vec4_words_to_dec(&buf[0], &tmp[0], words);
+	    string dec (&buf[0], ndigits);
+	    string ref = reference_to_dec(val, width);
+	    vec4_dec_to_words(&tmp[0], words, dec.c_str(), ndigits);
+	    if (dec != ref || tmp != val) {
+		  printf("decimal conversion differs at width %u\n", width);
+		  errors += 1;
+	    }
+
+	      // Narrow values are converted in batches so that reading
+	      // the clock does not swamp the time of the calls.
+	    unsigned batch = 65536 / width;
+
+	    timer_s to_dec;
+	    do {
+		  for (unsigned idx = 0 ; idx < batch ; idx += 1) {
+			tmp = val;
+			vec4_words_to_dec(&buf[0], &tmp[0], words);
+		  }
+		  to_dec.calls += batch;
+	    } while (to_dec.more());
+	    double to_dec_us = to_dec.usec_per_call();
+
+	    timer_s from_dec;
+	    do {
+		  for (unsigned idx = 0 ; idx < batch ; idx += 1)
+			vec4_dec_to_words(&tmp[0], words, dec.c_str(), ndigits);
+		  from_dec.calls += batch;
+	    } while (from_dec.more());
+	    double from_dec_us = from_dec.usec_per_call();
+
+	    timer_s serial;
+	    do {
+		  reference_to_dec(val, width);
+		  serial.calls += 1;
+	    } while (serial.more());
+	    double serial_us = serial.usec_per_call();
+
+	    printf("%6u %12.3f %12.3f %12.3f\n", width,
+		   to_dec_us, from_dec_us, serial_us);
+      }
+
+      return errors? 1 : 0;
+}
@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "version_base.h"
+# include  "version_tag.h"
+# include  "config.h"
+# include  "design_image.h"
+# include  "parse_chunks.h"
+# include  "parse_misc.h"
+# include  "compile.h"
+# include  "parse.h"
+# include  <cstdlib>
+# include  <cstring>
+# include  <cassert>
+# include  <stdint.h>
+# include  <sys/stat.h>
+# ifndef __MINGW32__
+# include  <sys/mman.h>
+# endif
+# include  "ivl_alloc.h"
+
+/*
+ * The image starts with a header:
+ *
+ *    "VVPIMAGE"       magic
+ *    uint32_t         format version
+ *    uint32_t         0x01020304, to catch a foreign byte order
+ *    uint32_t + text  the version of the vvp that wrote the image
+ *    uint64_t         parse_token_fingerprint() of that vvp
+ *
+ * and then the tokens follow to the end of the file. Each token is a
+ * uint16_t token number followed by its value, if it has one. A
+ * change of the source line is recorded as a LINE_MARK followed by
+ * the uint32_t line number. The token values are:
+ *
+ *    T_NUMBER                              uint64_t
+ *    T_INSTR, T_LABEL, T_STRING, T_SYMBOL  uint32_t length + text
+ *    T_VECTOR                              uint32_t width, then
+ *                                          uint32_t length + text
+ */
+static const char image_magic[8] = { 'V','V','P','I','M','A','G','E' };
+static const uint32_t image_format = 2;
+static const uint32_t image_order = 0x01020304;
+static const char image_version[] = VERSION " (" VERSION_TAG ")";
+static const uint16_t LINE_MARK = 0xffff;
+
+const char*design_image_save_path = 0;
+
+/* The image being saved. The tokens are collected in save_buf and
+   written out a block at a time. */
+static FILE*save_fd = 0;
+static token_buf save_buf;
+static const size_t SAVE_BLOCK = 1024*1024;
+
+/* The image being loaded. */
+static const char*load_base = 0;
+static size_t load_size = 0;
+static bool load_mapped = false;
+static token_reader load_rd;
+
+void token_buf::release()
+{
+      free(data);
+      data = 0;
+      size = 0;
+      alloc = 0;
+}
+
+static void put_bytes(token_buf&buf, const void*data, size_t size)
+{
+      if (buf.size + size > buf.alloc) {
+	    buf.alloc = buf.alloc? 2*buf.alloc : 64*1024;
+	    while (buf.size + size > buf.alloc)
+		  buf.alloc *= 2;
+	    buf.data = (char*)realloc(buf.data, buf.alloc);
+      }
+      memcpy(buf.data + buf.size, data, size);
+      buf.size += size;
+}
+
+static void put_u16(token_buf&buf, uint16_t val) { put_bytes(buf, &val, sizeof val); }
+static void put_u32(token_buf&buf, uint32_t val) { put_bytes(buf, &val, sizeof val); }
+
+static void put_text(token_buf&buf, const char*text)
+{
+      uint32_t len = strlen(text);
+      put_u32(buf, len);
+      put_bytes(buf, text, len);
+}
+
+void token_buf::put(int tok, const YYSTYPE&val, unsigned tok_line)
+{
+      if (tok_line != line) {
+	    put_u16(*this, LINE_MARK);
+	    put_u32(*this, tok_line);
+	    line = tok_line;
+      }
+
+      assert(tok >= 0 && tok < LINE_MARK);
+      put_u16(*this, tok);
+
+      switch (tok) {
+	  case T_NUMBER:
+	    put_bytes(*this, &val.numb, sizeof(uint64_t));
+	    break;
+	  case T_INSTR:
+	  case T_LABEL:
+	  case T_STRING:
+	  case T_SYMBOL:
+	    put_text(*this, val.text);
+	    break;
+	  case T_VECTOR:
+	    put_u32(*this, val.vect.idx);
+	    put_text(*this, val.vect.text);
+	    break;
+	  default:
+	    break;
+      }
+}
+
+static void save_flush(void)
+{
+      fwrite(save_buf.data, 1, save_buf.size, save_fd);
+      save_buf.size = 0;
+}
+
+bool design_image_save(void)
+{
+      assert(design_image_save_path);
+      save_fd = fopen(design_image_save_path, "wb");
+      if (save_fd == 0) {
+	    fprintf(stderr, "%s: Unable to open design image for writing.\n",
+	            design_image_save_path);
+	    return false;
+      }
+
+      put_bytes(save_buf, image_magic, sizeof image_magic);
+      put_u32(save_buf, image_format);
+      put_u32(save_buf, image_order);
+      put_text(save_buf, image_version);
+      uint64_t fingerprint = parse_token_fingerprint();
+      put_bytes(save_buf, &fingerprint, sizeof fingerprint);
+      save_buf.line = 0;
+      return true;
+}
+
+/*
+ * Read a value from the tokens. A short image ends the token stream
+ * early, and the parser reports the unexpected end of input.
+ */
+static bool load_bytes(token_reader&rd, void*data, size_t size)
+{
+      if ((size_t)(rd.end - rd.ptr) < size) {
+	    if (rd.ptr != rd.end)
+		  fprintf(stderr, "%s: Design image is truncated.\n", rd.path);
+	    rd.ptr = rd.end;
+	    return false;
+      }
+      memcpy(data, rd.ptr, size);
+      rd.ptr += size;
+      return true;
+}
+
+static bool load_text(token_reader&rd, char*&text, uint32_t&len, bool with_new)
+{
+      if (! load_bytes(rd, &len, sizeof len)) return false;
+      if ((size_t)(rd.end - rd.ptr) < len) {
+	    fprintf(stderr, "%s: Design image is truncated.\n", rd.path);
+	    rd.ptr = rd.end;
+	    return false;
+      }
+	/* The parser releases T_STRING text with delete[] and the
+	   rest with free(), like the text the lexor makes. */
+      text = with_new? new char[len+1] : (char*)malloc(len+1);
+      memcpy(text, rd.ptr, len);
+      text[len] = 0;
+      rd.ptr += len;
+      return true;
+}
+
+int token_read(token_reader&rd)
+{
+      uint16_t tok;
+      uint32_t len;
+
+      for (;;) {
+	    if (rd.ptr == rd.end) return 0;
+	    if (! load_bytes(rd, &tok, sizeof tok)) return 0;
+	    if (tok != LINE_MARK) break;
+	    uint32_t line;
+	    if (! load_bytes(rd, &line, sizeof line)) return 0;
+	    yyline = rd.line_base + line;
+      }
+
+      switch (tok) {
+	  case T_NUMBER:
+	    if (! load_bytes(rd, &yylval.numb, sizeof(uint64_t))) return 0;
+	    break;
+	  case T_INSTR:
+	  case T_LABEL:
+	  case T_SYMBOL:
+	    if (! load_text(rd, yylval.text, len, false)) return 0;
+	    break;
+	  case T_STRING:
+	    if (! load_text(rd, yylval.text, len, true)) return 0;
+	    break;
+	  case T_VECTOR: {
+		uint32_t wid;
+		char*text;
+		if (! load_bytes(rd, &wid, sizeof wid)) return 0;
+		if (! load_text(rd, text, len, false)) return 0;
+		  /* The lexor allocates room for the sign flag. */
+		if (len < wid + 1) {
+		      text = (char*)realloc(text, wid + 2);
+		}
+		yylval.vect.idx = wid;
+		yylval.vect.text = text;
+		break;
+	  }
+	  default:
+	    break;
+      }
+
+      return tok;
+}
+
+/*
+ * This is the token source for the parser. It takes the tokens from
+ * the loaded image if there is one, from the chunks scanned by the
+ * lexor threads, or else from the lexor, and copies them to the image
+ * that is being saved.
+ */
+int yylex(void)
+{
+      int tok;
+      if (load_base)
+	    tok = token_read(load_rd);
+      else if (parse_chunks_active)
+	    tok = parse_chunks_token();
+      else
+	    tok = yylex_text();
+
+      if (save_fd && tok != 0) {
+	    save_buf.put(tok, yylval, yyline);
+	    if (save_buf.size >= SAVE_BLOCK) save_flush();
+      }
+      return tok;
+}
+
+static void load_unmap(void)
+{
+#ifndef __MINGW32__
+      if (load_mapped) {
+	    munmap((void*)load_base, load_size);
+	    load_base = 0;
+	    return;
+      }
+#endif
+      free((void*)load_base);
+      load_base = 0;
+}
+
+int design_image_load(FILE*fd, const char*path)
+{
+      char magic[sizeof image_magic];
+      size_t cnt = fread(magic, 1, sizeof magic, fd);
+      if (cnt != sizeof magic || memcmp(magic, image_magic, cnt) != 0) {
+	    rewind(fd);
+	    return 0;
+      }
+
+      load_mapped = false;
+      load_base = 0;
+
+#ifndef __MINGW32__
+      struct stat sb;
+      if (fstat(fileno(fd), &sb) == 0 && S_ISREG(sb.st_mode)) {
+	    void*map = mmap(0, sb.st_size, PROT_READ, MAP_PRIVATE,
+	                    fileno(fd), 0);
+	    if (map != MAP_FAILED) {
+# ifdef MADV_SEQUENTIAL
+		  madvise(map, sb.st_size, MADV_SEQUENTIAL);
+# endif
+		  load_base = (const char*)map;
+		  load_size = sb.st_size;
+		  load_mapped = true;
+	    }
+      }
+#endif
+
+      if (load_base == 0) {
+	      /* Read the whole file into memory. */
+	    size_t alloc = 1024*1024;
+	    char*buf = (char*)malloc(alloc);
+	    memcpy(buf, magic, sizeof magic);
+	    load_size = sizeof magic;
+	    while ((cnt = fread(buf+load_size, 1, alloc-load_size, fd)) > 0) {
+		  load_size += cnt;
+		  if (load_size == alloc) {
+			alloc *= 2;
+			buf = (char*)realloc(buf, alloc);
+		  }
+	    }
+	    load_base = buf;
+      }
+
+      load_rd.ptr = load_base + sizeof magic;
+      load_rd.end = load_base + load_size;
+      load_rd.line_base = 0;
+      load_rd.path = path;
+
+      uint32_t format = 0, order = 0, len = 0;
+      load_bytes(load_rd, &format, sizeof format);
+      load_bytes(load_rd, &order, sizeof order);
+      load_bytes(load_rd, &len, sizeof len);
+      if (format != image_format || order != image_order
+	  || len != strlen(image_version)
+	  || (size_t)(load_rd.end - load_rd.ptr) < len
+	  || memcmp(load_rd.ptr, image_version, len) != 0) {
+	    fprintf(stderr, "%s: Design image was not written by this "
+	            "version of vvp (%s).\n", path, image_version);
+	    load_unmap();
+	    return -1;
+      }
+      load_rd.ptr += len;
+
+      uint64_t fingerprint = 0;
+      load_bytes(load_rd, &fingerprint, sizeof fingerprint);
+      if (fingerprint != parse_token_fingerprint()) {
+	    fprintf(stderr, "%s: Design image was written by a vvp with "
+	            "other token numbers.\n", path);
+	    load_unmap();
+	    return -1;
+      }
+
+      if (verbose_flag)
+	    vpi_mcd_printf(1, " ... Loading design image %s (%zu bytes)\n",
+	                   path, load_size);
+
+      return 1;
+}
+
+void design_image_close(bool ok)
+{
+      if (load_base) load_unmap();
+
+      if (save_fd) {
+	    save_flush();
+	    save_buf.release();
+	    fclose(save_fd);
+	    save_fd = 0;
+	    if (! ok) remove(design_image_save_path);
+      }
+}
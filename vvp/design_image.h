@@ -0,0 +1,111 @@
+#ifndef IVL_design_image_H
+#define IVL_design_image_H
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  <cstdio>
+# include  <cstddef>
+
+union YYSTYPE;
+
+/*
+ * A design image is a precompiled form of a .vvp design file. It
+ * holds the token stream that the lexor makes from the text, with the
+ * token values already converted, so loading an image skips the text
+ * scanning, the number conversions and the string unquoting. The
+ * parser and the link steps still run as usual on the replayed
+ * tokens, so an image gives exactly the same design as its source.
+ *
+ * An image is tied to the vvp that wrote it. It is in the native
+ * byte order and token numbering, and is rejected by any other
+ * version of vvp.
+ */
+
+/*
+ * If this is set, the tokens of the design being compiled are also
+ * written as an image to this path. It is set by the -save-image=
+ * extended argument.
+ */
+extern const char*design_image_save_path;
+
+/*
+ * Look at the start of the opened design file to see if it is an
+ * image. Return 1 if it is and the image is ready to be read by
+ * yylex, 0 if the file is not an image (the file is left at the
+ * start) or -1 if the file is an image that cannot be used. An error
+ * message has already been printed in that case.
+ */
+extern int design_image_load(FILE*fd, const char*path);
+
+/*
+ * Start writing the image to design_image_save_path. Return false if
+ * the file cannot be opened.
+ */
+extern bool design_image_save(void);
+
+/*
+ * Finish with the image that was loaded or saved. If the compile
+ * failed, the image that was being written is removed.
+ */
+extern void design_image_close(bool ok);
+
+/*
+ * A token_buf holds tokens in the encoding of an image. The design
+ * image is written through one, and the lexor threads that scan the
+ * chunks of a large design file (see parse_chunks.h) each fill one
+ * for the parser to read back. The line of each token is recorded
+ * when it changes from that of the previous token.
+ */
+struct token_buf {
+      token_buf() : data(0), size(0), alloc(0), line(0) { }
+      ~token_buf() { release(); }
+
+      void put(int tok, const union YYSTYPE&val, unsigned line);
+      void release();
+
+      char*data;
+      size_t size;
+      size_t alloc;
+	// The line of the token last put in the buffer.
+      unsigned line;
+
+    private: // not implemented
+      token_buf(const token_buf&);
+      token_buf& operator= (const token_buf&);
+};
+
+/*
+ * A token_reader gets tokens back from a token_buf or an image. The
+ * recorded lines are offset by line_base. The path is the name of the
+ * file for error messages.
+ */
+struct token_reader {
+      const char*ptr;
+      const char*end;
+      unsigned line_base;
+      const char*path;
+};
+
+/*
+ * Read the next token into yylval and yyline, and return it, or
+ * return 0 at the end of the tokens.
+ */
+extern int token_read(token_reader&rd);
+
+#endif /* IVL_design_image_H */
@@ -0,0 +1,43 @@
+# Copyright (c) 2026 The Icarus Verilog developers
+#
+#    This program is free software; you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation; either version 2 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License along
+#    with this program; if not, write to the Free Software Foundation, Inc.,
+#    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+# Write a large design for the "make bench" startup benchmark. It is a
+# chain of N gates with a little thread code per gate, so nearly all of
+# the run time is spent reading and linking the design. Use it as:
+#
+#    awk -v N=200000 -f startup_bench.awk > startup_bench.vvp
+
+BEGIN {
+      if (N == 0) N = 200000;
+      print ":ivl_version \"12.0\" \"vec4-stack\";";
+      print ":vpi_module \"system\";";
+      print "S_main .scope module, \"main\" \"main\" 0 0;";
+      print "v_a .var \"a\", 0 0;";
+      print "v_b .var \"b\", 0 0;";
+      print "L_0 .functor AND 1, v_a, v_b, C4<1>, C4<1>;";
+      for (i = 1 ; i < N ; i += 1)
+	    printf("L_%d .functor AND 1, L_%d, v_b, C4<1>, C4<1>;\n", i, i-1);
+      print "T_0\t%load/vec4 v_b;";
+      for (i = 0 ; i < N ; i += 100)
+	    print "\t%store/vec4 v_b, 0, 1;\n\t%load/vec4 v_b;";
+      print "\t%pop/vec4 1;";
+      print "\t%vpi_call 0 0 \"$display\", \"startup done\" {0 0 0};";
+      print "\t%end;";
+      print "\t.thread T_0;";
+      print ":file_names 2;";
+      print "    \"N/A\";";
+      print "    \"<interactive>\";";
+}
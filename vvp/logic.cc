@@ -44,8 +44,11 @@ void vvp_fun_boolean_::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                                  vvp_context_t)
 {
       unsigned port = ptr.port();
-      if (input_[port] .eeq( bit ))
+      count_vec4_checked += 1;
+      if (input_[port] .eeq( bit )) {
+	    count_vec4_suppressed += 1;
 	    return;
+      }
 
       input_[port] = bit;
       if (net_ == 0) {
@@ -65,8 +68,11 @@ void vvp_fun_boolean_::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 
 	// Set the part for the input. If nothing changes, then break.
       bool flag = input_[port] .set_vec(base, bit);
-      if (flag == false)
+      count_vec4_checked += 1;
+      if (flag == false) {
+	    count_vec4_suppressed += 1;
 	    return;
+      }
 
       if (net_ == 0) {
 	    net_ = ptr.ptr();
@@ -179,8 +185,11 @@ void vvp_fun_buf::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
       if (ptr.port() != 0)
 	    return;
 
-      if (input_ .eeq( bit ))
+      count_vec4_checked += 1;
+      if (input_ .eeq( bit )) {
+	    count_vec4_suppressed += 1;
 	    return;
+      }
 
       input_ = bit;
 
@@ -202,8 +211,11 @@ void vvp_fun_buf::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 
 	// Set the input part. If nothing changes, then break.
       bool flag = input_.set_vec(base, bit);
-      if (flag == false)
+      count_vec4_checked += 1;
+      if (flag == false) {
+	    count_vec4_suppressed += 1;
 	    return;
+      }
 
       if (net_ == 0) {
 	    net_ = ptr.ptr();
@@ -379,12 +391,20 @@ void vvp_fun_muxz::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 {
       switch (ptr.port()) {
 	  case 0:
-	    if (a_ .eeq(bit) && has_run_) return;
+	    count_vec4_checked += 1;
+	    if (a_ .eeq(bit) && has_run_) {
+		  count_vec4_suppressed += 1;
+		  return;
+	    }
 	    a_ = bit;
 	    if (select_ == SEL_PORT1) return; // The other port is selected.
 	    break;
 	  case 1:
-	    if (b_ .eeq(bit) && has_run_) return;
+	    count_vec4_checked += 1;
+	    if (b_ .eeq(bit) && has_run_) {
+		  count_vec4_suppressed += 1;
+		  return;
+	    }
 	    b_ = bit;
 	    if (select_ == SEL_PORT0) return; // The other port is selected.
 	    break;
@@ -506,8 +526,11 @@ void vvp_fun_not::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
       if (ptr.port() != 0)
 	    return;
 
-      if (input_ .eeq( bit ))
+      count_vec4_checked += 1;
+      if (input_ .eeq( bit )) {
+	    count_vec4_suppressed += 1;
 	    return;
+      }
 
       input_ = bit;
       if (net_ == 0) {
@@ -528,8 +551,11 @@ void vvp_fun_not::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 
 	// Set the part value. If nothing changes, then break.
       bool flag = input_.set_vec(base, bit);
-      if (flag == false)
+      count_vec4_checked += 1;
+      if (flag == false) {
+	    count_vec4_suppressed += 1;
 	    return;
+      }
 
       if (net_ == 0) {
 	    net_ = ptr.ptr();
@@ -27,6 +27,11 @@ const char COPYRIGHT[] =
 # include  "statistics.h"
 # include  "vvp_cleanup.h"
 # include  "vvp_object.h"
+# include  "vec4_kernels.h"
+# include  "design_image.h"
+# include  "parse_chunks.h"
+# include  <cctype>
+# include  <climits>
 # include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
@@ -251,7 +256,8 @@ static void final_cleanup()
 unsigned module_cnt = 0;
 const char*module_tab[64];
 
-extern void vpip_mcd_init(FILE *log);
+extern void vpip_mcd_init(FILE *log, size_t buffer_size,
+                          bool buffer_stdout);
 extern void vvp_vpi_init(void);
 
 int main(int argc, char*argv[])
@@ -262,6 +268,8 @@ int main(int argc, char*argv[])
       struct rusage cycles[3];
       const char *logfile_name = 0x0;
       FILE *logfile = 0x0;
+      bool unbuffered_flag = false;
+      size_t log_buffer_size = 0;
       extern void vpi_set_vlog_info(int, char**);
       extern bool stop_is_finish;
       extern int  stop_is_finish_exit_code;
@@ -301,6 +309,7 @@ int main(int argc, char*argv[])
            exit(0);
 	  case 'i':
 	    setvbuf(stdout, 0, _IONBF, 0);
+	    unbuffered_flag = true;
 	    break;
 	  case 'l':
 	    logfile_name = optarg;
@@ -376,6 +385,45 @@ int main(int argc, char*argv[])
 
       design_path = argv[optind];
 
+	/* A few extended arguments are for the runtime itself. These
+	   are looked at before any output is written, as the output
+	   buffers cannot be changed after that. */
+      for (int idx = optind+1 ; idx < argc ; idx += 1) {
+	    if (strcmp(argv[idx], "-nba-coalesce") == 0) {
+		  schedule_coalesce_nba = true;
+	    } else if (strncmp(argv[idx], "-save-image=", 12) == 0) {
+		  design_image_save_path = argv[idx] + 12;
+	    } else if (strncmp(argv[idx], "-parse-threads=", 15) == 0) {
+		  const char*arg = argv[idx] + 15;
+		  char*end;
+		  unsigned long val = strtoul(arg, &end, 10);
+		  if (!isdigit((unsigned char)*arg) || *end
+		      || val > PARSE_THREADS_MAX) {
+			fprintf(stderr, "%s: Ignoring invalid parse thread "
+			        "count %s.\n", argv[0], arg);
+		  } else {
+			parse_chunks_threads = val;
+		  }
+	    } else if (strncmp(argv[idx], "-log-buffer=", 12) == 0) {
+		  const char*arg = argv[idx] + 12;
+		  char*end;
+		  unsigned long val = strtoul(arg, &end, 10);
+		  unsigned shift = 0;
+		  switch (*end) {
+		      case 'k': case 'K': shift = 10; end += 1; break;
+		      case 'm': case 'M': shift = 20; end += 1; break;
+		      case 'g': case 'G': shift = 30; end += 1; break;
+		  }
+		  if (*end || end == arg || !isdigit((unsigned char)*arg)
+		      || val == ULONG_MAX || val > (ULONG_MAX >> shift)) {
+			fprintf(stderr, "%s: Ignoring invalid log buffer "
+			        "size %s.\n", argv[0], arg);
+		  } else {
+			log_buffer_size = val << shift;
+		  }
+	    }
+      }
+
 	/* This is needed to get the MCD I/O routines ready for
 	   anything. It is done early because it is plausible that the
 	   compile might affect it, and it is cheap to do. */
@@ -389,15 +437,24 @@ int main(int argc, char*argv[])
 		        perror(logfile_name);
 		        exit(1);
 		  }
-		  setvbuf(logfile, log_buffer, _IOLBF, sizeof(log_buffer));
+		  if (log_buffer_size == 0)
+			setvbuf(logfile, log_buffer, _IOLBF,
+				sizeof(log_buffer));
 	    }
       }
 
-      vpip_mcd_init(logfile);
+	/* With a log buffer size the standard output and the log file
+	   are fully buffered, so that chatty designs do not write a
+	   line at a time. The -i flag still wins for stdout. */
+      vpip_mcd_init(logfile, log_buffer_size, !unbuffered_flag);
+
+      vec4_kernels_select();
 
       if (verbose_flag) {
 	    my_getrusage(cycles+0);
 	    vpi_mcd_printf(1, "Compiling VVP ...\n");
+	    vpi_mcd_printf(1, " ... Using %s vector kernels\n",
+			   vec4_kernels->name);
       }
 
       vvp_vpi_init();
@@ -410,7 +467,9 @@ int main(int argc, char*argv[])
       for (unsigned idx = 0 ;  idx < module_cnt ;  idx += 1)
 	    vpip_load_module(module_tab[idx]);
 
+      load_clock_lap();
       int ret_cd = compile_design(design_path);
+      time_load_parse = load_clock_lap();
       destroy_lexor();
       print_vpi_call_errors();
       if (ret_cd) return ret_cd;
@@ -443,11 +502,15 @@ int main(int argc, char*argv[])
 	    vpi_mcd_printf(1, "           %8lu signals\n", count_functors_sig);
 	    vpi_mcd_printf(1, " ... %8lu filters (net_fil pool=%zu bytes)\n",
 			   count_filters, vvp_net_fil_t::heap_total());
-	    vpi_mcd_printf(1, " ... %8lu opcodes (%zu bytes)\n",
-	                   count_opcodes, size_opcodes);
+	    vpi_mcd_printf(1, " ... %8lu opcodes (%zu bytes, %lu fused)\n",
+	                   count_opcodes, size_opcodes, count_opcodes_fused);
 	    vpi_mcd_printf(1, " ... %8lu nets\n",     count_vpi_nets);
-	    vpi_mcd_printf(1, " ... %8lu vvp_nets (%zu bytes)\n",
-			   count_vvp_nets, size_vvp_nets);
+	    vpi_mcd_printf(1, " ... %8lu vvp_nets (%zu bytes, %.1f bytes/net, "
+			   "%zu bytes/vvp_net_t)\n",
+			   count_vvp_nets, size_vvp_nets,
+			   count_vvp_nets ? (double)size_vvp_nets / count_vvp_nets
+			                  : 0.0,
+			   sizeof(vvp_net_t));
 	    vpi_mcd_printf(1, " ... %8lu arrays (%lu words)\n",
 			   count_net_arrays, count_net_array_words);
 	    vpi_mcd_printf(1, " ... %8lu memories\n",
@@ -457,6 +520,12 @@ int main(int argc, char*argv[])
 	    vpi_mcd_printf(1, "           %8lu real (%lu words)\n",
 			   count_real_arrays, count_real_array_words);
 	    vpi_mcd_printf(1, " ... %8lu scopes\n",   count_vpi_scopes);
+	    vpi_mcd_printf(1, " ... %8lu deferred references (%lu waits)\n",
+			   count_resolv_deferred, count_resolv_waits);
+	    vpi_mcd_printf(1, " ... load phases: parse %.3f s, link %.3f s,"
+			   " symbols %.3f s, finish %.3f s, compiletf %.3f s\n",
+			   time_load_parse, time_load_link, time_load_symbols,
+			   time_load_finish, time_load_compiletf);
       }
 
       if (verbose_flag) {
@@ -473,24 +542,39 @@ int main(int argc, char*argv[])
 	    print_rusage(cycles+2, cycles+1);
 
 	    vpi_mcd_printf(1, "Event counts:\n");
-	    vpi_mcd_printf(1, "    %8lu time steps (pool=%lu)\n",
-			   count_time_events, count_time_pool());
+	    vpi_mcd_printf(1, "    %8lu time steps (pool=%lu, %lu in use)\n",
+			   count_time_events, count_time_pool(),
+			   count_time_pool_used());
+	    vpi_mcd_printf(1, "    %8lu event inserts (%.2f time wheel "
+			   "placements/insert)\n", count_schedule_inserts,
+			   count_schedule_inserts ? (double)count_schedule_places
+			                          / count_schedule_inserts : 0.0);
 	    vpi_mcd_printf(1, "    %8lu thread schedule events\n",
 		    count_thread_events);
 	    vpi_mcd_printf(1, "    %8lu assign events\n",
 		    count_assign_events);
-	    vpi_mcd_printf(1, "             ...assign(vec4) pool=%lu\n",
-			   count_assign4_pool());
-	    vpi_mcd_printf(1, "             ...assign(vec8) pool=%lu\n",
-			   count_assign8_pool());
-	    vpi_mcd_printf(1, "             ...assign(real) pool=%lu\n",
-			   count_assign_real_pool());
-	    vpi_mcd_printf(1, "             ...assign(word) pool=%lu\n",
-			   count_assign_aword_pool());
-	    vpi_mcd_printf(1, "             ...assign(word/r) pool=%lu\n",
-			   count_assign_arword_pool());
-	    vpi_mcd_printf(1, "    %8lu other events (pool=%lu)\n",
-			   count_gen_events, count_gen_pool());
+	    if (schedule_coalesce_nba)
+		  vpi_mcd_printf(1, "             ...%lu elided\n",
+				 count_assign_elided);
+	    vpi_mcd_printf(1, "             ...assign(vec4) pool=%lu, %lu in use\n",
+			   count_assign4_pool(), count_assign4_pool_used());
+	    vpi_mcd_printf(1, "             ...assign(vec8) pool=%lu, %lu in use\n",
+			   count_assign8_pool(), count_assign8_pool_used());
+	    vpi_mcd_printf(1, "             ...assign(real) pool=%lu, %lu in use\n",
+			   count_assign_real_pool(), count_assign_real_pool_used());
+	    vpi_mcd_printf(1, "             ...assign(word) pool=%lu, %lu in use\n",
+			   count_assign_aword_pool(), count_assign_aword_pool_used());
+	    vpi_mcd_printf(1, "             ...assign(word/r) pool=%lu, %lu in use\n",
+			   count_assign_arword_pool(), count_assign_arword_pool_used());
+	    vpi_mcd_printf(1, "             ...force(vec4) pool=%lu, %lu in use\n",
+			   count_force4_pool(), count_force4_pool_used());
+	    vpi_mcd_printf(1, "    %8lu other events (pool=%lu, %lu in use)\n",
+			   count_gen_events, count_gen_pool(),
+			   count_gen_pool_used());
+	    vpi_mcd_printf(1, "    %8lu vec4 inputs delivered (%lu suppressed "
+			   "as unchanged)\n",
+			   count_vec4_checked - count_vec4_suppressed,
+			   count_vec4_suppressed);
       }
 
       final_cleanup();
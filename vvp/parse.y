@@ -22,6 +22,8 @@
 # include  "parse_misc.h"
 # include  "compile.h"
 # include  "delay.h"
+# include  "design_image.h"
+# include  "parse_chunks.h"
 # include  <list>
 # include  <cstdio>
 # include  <cstdlib>
@@ -31,11 +33,6 @@
 
 using namespace std;
 
-/*
- * These are bits in the lexor.
- */
-extern FILE*yyin;
-
 vector <const char*> file_names;
 
 /*
@@ -49,6 +46,9 @@ vector <const char*> file_names;
 static struct __vpiModPath*modpath_dst = 0;
 %}
 
+/* Keep the names of the tokens, for parse_token_fingerprint. */
+%token-table
+
 %union {
       char*text;
       char **table;
@@ -1239,17 +1239,56 @@ delay
 
 %%
 
+/*
+ * A design image keeps the token numbers, so an image is only good
+ * for a vvp with the same numbering. Hash the name of the token that
+ * each token number stands for.
+ */
+uint64_t parse_token_fingerprint(void)
+{
+      uint64_t hash = 0xcbf29ce484222325ULL;
+      for (int tok = 0 ; tok <= YYMAXUTOK ; tok += 1) {
+	    const char*name = yytname[YYTRANSLATE(tok)];
+	      /* The nul ends each name, so that adjacent names stay
+		 apart. */
+	    for (const char*cp = name ;  ; cp += 1) {
+		  hash = (hash ^ (unsigned char)*cp) * 0x100000001b3ULL;
+		  if (*cp == 0) break;
+	    }
+      }
+      return hash;
+}
+
 int compile_design(const char*path)
 {
       yypath = path;
       yyline = 1;
-      yyin = fopen(path, "r");
-      if (yyin == 0) {
+      FILE*fd = fopen(path, "rb");
+      if (fd == 0) {
 	    fprintf(stderr, "%s: Unable to open input file.\n", path);
 	    return -1;
       }
 
+	/* The input may be a design image instead of text. A large
+	   text file is scanned on several threads. */
+      int image = design_image_load(fd, path);
+      if (image < 0) {
+	    fclose(fd);
+	    return -1;
+      }
+      if (image == 0 && ! parse_chunks_start(fd, path))
+	    lexor_open(fd);
+
+      if (design_image_save_path && !design_image_save()) {
+	    parse_chunks_stop();
+	    design_image_close(false);
+	    fclose(fd);
+	    return -1;
+      }
+
       int rc = yyparse();
-      fclose(yyin);
+      parse_chunks_stop();
+      design_image_close(rc == 0);
+      fclose(fd);
       return rc;
 }
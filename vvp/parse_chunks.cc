@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+
+# include  "config.h"
+# include  "parse_chunks.h"
+# include  "design_image.h"
+# include  "parse_misc.h"
+# include  "compile.h"
+# include  "parse.h"
+# include  <cstdlib>
+# include  <cstring>
+# include  <cassert>
+# include  <pthread.h>
+# include  <unistd.h>
+# include  <sys/stat.h>
+# ifndef __MINGW32__
+# include  <sys/mman.h>
+# endif
+
+unsigned parse_chunks_threads = 0;
+bool parse_chunks_active = false;
+
+/* Files smaller than this are scanned on the main thread unless the
+   number of threads is given. */
+static const size_t CHUNK_FILE_MIN = 4*1024*1024;
+/* The chunks are cut to about this size, though a given number of
+   threads may cut a small file finer. The lexor takes the size of a
+   buffer as an int, so a chunk must not get near 2G. */
+static const size_t CHUNK_MIN = 1024*1024;
+static const size_t CHUNK_MAX = 64*1024*1024;
+/* No more than this many threads are started by default. */
+static const unsigned THREADS_MAX = 8;
+
+struct parse_chunk_s {
+      const char*text;
+      size_t size;
+	// The tokens, and the number of lines in the chunk text.
+      token_buf tokens;
+      unsigned lines;
+      bool done;
+};
+
+static const char*map_base = 0;
+static size_t map_size = 0;
+
+static parse_chunk_s*chunks = 0;
+static unsigned chunk_count = 0;
+
+/* These are shared with the lexor threads, under chunk_lock. The
+   lexor threads take chunks in order from chunk_next, but stay at
+   most chunk_window chunks ahead of chunk_cur, the chunk that the
+   parser is reading, so that the tokens do not pile up. */
+static pthread_mutex_t chunk_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t chunk_scanned = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t chunk_room = PTHREAD_COND_INITIALIZER;
+static unsigned chunk_next = 0;
+static unsigned chunk_cur = 0;
+static unsigned chunk_window = 0;
+static bool chunk_stop = false;
+
+static pthread_t*lexor_threads = 0;
+static unsigned lexor_thread_count = 0;
+
+/* The parser side. */
+static bool chunk_reading = false;
+static unsigned chunk_line_base = 0;
+static token_reader chunk_rd;
+
+static void* lexor_thread(void*)
+{
+      pthread_mutex_lock(&chunk_lock);
+      for (;;) {
+	    while (!chunk_stop && chunk_next < chunk_count
+		   && chunk_next >= chunk_cur + chunk_window)
+		  pthread_cond_wait(&chunk_room, &chunk_lock);
+	    if (chunk_stop || chunk_next >= chunk_count)
+		  break;
+
+	    parse_chunk_s*chunk = chunks + chunk_next;
+	    chunk_next += 1;
+	    pthread_mutex_unlock(&chunk_lock);
+
+	    lexor_scan_chunk(chunk->text, chunk->size, chunk->tokens,
+			     chunk->lines);
+
+	    pthread_mutex_lock(&chunk_lock);
+	    chunk->done = true;
+	    pthread_cond_broadcast(&chunk_scanned);
+      }
+      pthread_mutex_unlock(&chunk_lock);
+      return 0;
+}
+
+static inline bool is_label_start(char ch)
+{
+      return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z')
+	    || ch == '.' || ch == '$' || ch == '_' || ch == '\\';
+}
+
+/*
+ * Find the first line at or after pos that starts with a label. Every
+ * statement with a label starts a line, and the lexor treats a line
+ * the same wherever it starts scanning, so the chunks are scanned to
+ * the same tokens as the whole file. Only a string may go on to the
+ * next line, and tgt-vvp escapes the newlines in strings.
+ */
+static const char* chunk_boundary(const char*pos, const char*end)
+{
+      while (pos < end) {
+	    const char*nl = (const char*)memchr(pos, '\n', end - pos);
+	    if (nl == 0) break;
+	    pos = nl + 1;
+	    if (pos < end && is_label_start(*pos))
+		  return pos;
+      }
+      return end;
+}
+
+static void release_chunks(void)
+{
+      delete[]chunks;
+      chunks = 0;
+      chunk_count = 0;
+#ifndef __MINGW32__
+      if (map_base) munmap((void*)map_base, map_size);
+#endif
+      map_base = 0;
+}
+
+bool parse_chunks_start(FILE*fd, const char*path)
+{
+#ifdef __MINGW32__
+      return false;
+#else
+      unsigned threads = parse_chunks_threads;
+      size_t want_min = 1;
+      if (threads == 1)
+	    return false;
+
+      struct stat sb;
+      if (fstat(fileno(fd), &sb) != 0 || ! S_ISREG(sb.st_mode))
+	    return false;
+      size_t size = sb.st_size;
+
+      if (threads == 0) {
+	    if (size < CHUNK_FILE_MIN)
+		  return false;
+	    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	    if (cpus < 2)
+		  return false;
+	    threads = cpus < (long)THREADS_MAX? cpus : THREADS_MAX;
+	    want_min = CHUNK_MIN;
+      }
+
+	/* The main thread parses, and the rest scan. Cut the file to a
+	   few chunks per lexor thread, so that a thread that finishes
+	   early can take another. */
+      unsigned scanners = threads - 1;
+      size_t want = size / (4 * scanners);
+      if (want < want_min) want = want_min;
+      if (want > CHUNK_MAX) want = CHUNK_MAX;
+
+      void*map = mmap(0, size, PROT_READ, MAP_PRIVATE, fileno(fd), 0);
+      if (map == MAP_FAILED)
+	    return false;
+      map_base = (const char*)map;
+      map_size = size;
+
+      const char*end = map_base + size;
+      unsigned count = 0;
+      for (const char*cp = map_base ; cp < end ; count += 1)
+	    cp = chunk_boundary(cp + want < end? cp + want : end, end);
+
+      chunks = new parse_chunk_s[count];
+      chunk_count = 0;
+      for (const char*cp = map_base ; cp < end ; chunk_count += 1) {
+	    const char*next = chunk_boundary(cp + want < end? cp + want : end, end);
+	    parse_chunk_s*chunk = chunks + chunk_count;
+	    chunk->text = cp;
+	    chunk->size = next - cp;
+	    chunk->lines = 0;
+	    chunk->done = false;
+	    cp = next;
+      }
+      assert(chunk_count == count);
+
+      if (chunk_count < 2) {
+	    release_chunks();
+	    return false;
+      }
+
+      chunk_next = 0;
+      chunk_cur = 0;
+      chunk_window = 2 * scanners;
+      chunk_stop = false;
+      chunk_reading = false;
+      chunk_line_base = yyline;
+      chunk_rd.ptr = 0;
+      chunk_rd.end = 0;
+      chunk_rd.line_base = 0;
+      chunk_rd.path = path;
+
+      lexor_threads = new pthread_t[scanners];
+      lexor_thread_count = 0;
+      for (unsigned idx = 0 ; idx < scanners ; idx += 1) {
+	    if (pthread_create(lexor_threads+lexor_thread_count, 0,
+			       lexor_thread, 0) != 0)
+		  break;
+	    lexor_thread_count += 1;
+      }
+
+      if (lexor_thread_count == 0) {
+	    delete[]lexor_threads;
+	    lexor_threads = 0;
+	    release_chunks();
+	    return false;
+      }
+
+      if (verbose_flag)
+	    vpi_mcd_printf(1, " ... Scanning %s in %u chunks on %u threads\n",
+			   path, chunk_count, lexor_thread_count);
+
+      parse_chunks_active = true;
+      return true;
+#endif
+}
+
+/*
+ * Move the reader on to the next chunk, when it has been scanned.
+ * The tokens of the chunk that was read are released.
+ */
+static bool next_chunk(void)
+{
+      pthread_mutex_lock(&chunk_lock);
+      if (chunk_reading && chunk_cur < chunk_count) {
+	    parse_chunk_s*chunk = chunks + chunk_cur;
+	    chunk_line_base += chunk->lines;
+	    chunk->tokens.release();
+	    chunk_cur += 1;
+	    pthread_cond_broadcast(&chunk_room);
+      }
+      chunk_reading = true;
+
+      if (chunk_cur >= chunk_count) {
+	    pthread_mutex_unlock(&chunk_lock);
+	    return false;
+      }
+
+      parse_chunk_s*chunk = chunks + chunk_cur;
+      while (! chunk->done)
+	    pthread_cond_wait(&chunk_scanned, &chunk_lock);
+      pthread_mutex_unlock(&chunk_lock);
+
+      chunk_rd.ptr = chunk->tokens.data;
+      chunk_rd.end = chunk->tokens.data + chunk->tokens.size;
+      chunk_rd.line_base = chunk_line_base;
+      yyline = chunk_line_base;
+      return true;
+}
+
+int parse_chunks_token(void)
+{
+      for (;;) {
+	    int tok = token_read(chunk_rd);
+	    if (tok != 0)
+		  return tok;
+	    if (! next_chunk())
+		  return 0;
+      }
+}
+
+void parse_chunks_stop(void)
+{
+      if (! parse_chunks_active)
+	    return;
+
+	/* The parser may have stopped on an error before the end. */
+      pthread_mutex_lock(&chunk_lock);
+      chunk_stop = true;
+      pthread_cond_broadcast(&chunk_room);
+      pthread_mutex_unlock(&chunk_lock);
+
+      for (unsigned idx = 0 ; idx < lexor_thread_count ; idx += 1)
+	    pthread_join(lexor_threads[idx], 0);
+      delete[]lexor_threads;
+      lexor_threads = 0;
+      lexor_thread_count = 0;
+
+      release_chunks();
+      parse_chunks_active = false;
+}
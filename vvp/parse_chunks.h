@@ -0,0 +1,68 @@
+#ifndef IVL_parse_chunks_H
+#define IVL_parse_chunks_H
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  <cstdio>
+
+/*
+ * A large design file is cut into chunks at the start of statements,
+ * and the chunks are scanned by the lexor on several threads at once,
+ * each into its own token_buf. The parser takes the tokens of the
+ * chunks in file order, so the design is compiled exactly as if the
+ * file were scanned on the main thread, but the main thread only has
+ * to parse and link while the other threads scan ahead of it.
+ */
+
+/*
+ * This is the number of threads to use, including the main thread.
+ * It is set by the -parse-threads= extended argument. 0 picks the
+ * number of processors for large files, and 1 scans the design file
+ * on the main thread.
+ */
+extern unsigned parse_chunks_threads;
+
+/*
+ * A larger count than this is refused.
+ */
+static const unsigned PARSE_THREADS_MAX = 64;
+
+/*
+ * This is true while yylex takes its tokens from parse_chunks_token.
+ */
+extern bool parse_chunks_active;
+
+/*
+ * Start scanning the opened design file on the lexor threads. Return
+ * false if the file is to be scanned on the main thread instead.
+ */
+extern bool parse_chunks_start(FILE*fd, const char*path);
+
+/*
+ * Get the next token of the chunks into yylval and yyline, waiting
+ * for the chunk to be scanned if need be. Return 0 at the end.
+ */
+extern int parse_chunks_token(void);
+
+/*
+ * Stop the lexor threads and release the chunks.
+ */
+extern void parse_chunks_stop(void);
+
+#endif /* IVL_parse_chunks_H */
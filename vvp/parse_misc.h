@@ -20,6 +20,7 @@
  */
 
 # include  "vpi_priv.h"
+# include  <cstdio>
 
 /*
  * This method is called to compile the design file. The input is read
@@ -44,8 +45,30 @@ extern void set_delay_selection(const char* sel);
 extern int yylex(void);
 extern void yyerror(const char*msg);
 
+/*
+ * This is the lexor proper. The yylex function calls it when the
+ * design is read from text on the main thread, after lexor_open has
+ * given it the opened design file.
+ */
+extern void lexor_open(FILE*fd);
+extern int yylex_text(void);
+
+/*
+ * Scan a chunk of the design file text into the tokens buffer. The
+ * number of lines in the chunk is returned in lines. This may be
+ * called on any thread.
+ */
+struct token_buf;
+extern void lexor_scan_chunk(const char*text, size_t size,
+			     struct token_buf&tokens, unsigned&lines);
+
 extern void destroy_lexor();
 
+/*
+ * Return a hash of the token numbers that the parser uses.
+ */
+extern uint64_t parse_token_fingerprint(void);
+
 /*
  * This is the path of the current source file.
  */
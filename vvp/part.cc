@@ -20,6 +20,7 @@
 # define __STDC_LIMIT_MACROS
 # include  "compile.h"
 # include  "part.h"
+# include  "statistics.h"
 # include  <cstdlib>
 # include  <climits>
 # include  <stdint.h>
@@ -60,8 +61,11 @@ void vvp_fun_part_sa::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
       assert(port.port() == 0);
 
       vvp_vector4_t tmp (bit, base_, wid_);
-      if (val_ .eeq( tmp ))
+      count_vec4_checked += 1;
+      if (val_ .eeq( tmp )) {
+	    count_vec4_suppressed += 1;
 	    return;
+      }
 
       val_ = tmp;
 
@@ -26,6 +26,8 @@
 # include  "compile.h"
 # include  <new>
 # include  <typeinfo>
+# include  <vector>
+# include  <algorithm>
 # include  <csignal>
 # include  <cstdlib>
 # include  <cassert>
@@ -38,11 +40,17 @@
 using namespace std;
 
 unsigned long count_assign_events = 0;
+  // Count the non-blocking assignments that were merged into an
+  // earlier assignment to the same input (see schedule_assign_vector).
+unsigned long count_assign_elided = 0;
 unsigned long count_gen_events = 0;
 unsigned long count_thread_events = 0;
   // Count the time events (A time cell created)
 unsigned long count_time_events = 0;
-
+  // Count the events inserted into the time wheel, and the number of
+  // time cell placements (including cascades) needed to do it.
+unsigned long count_schedule_inserts = 0;
+unsigned long count_schedule_places = 0;
 
 
 /*
@@ -51,6 +59,8 @@ unsigned long count_time_events = 0;
  *
  * The event_time_s objects are one per time step. Each time step in
  * turn contains a list of event_s objects that are the actual events.
+ * The event_time_s objects themselves are kept in a timing wheel (see
+ * below) and carry the absolute time of the step.
  *
  * The event_s objects are base classes for the more specific sort of
  * event.
@@ -76,7 +86,7 @@ void event_s::single_step_display(void)
 struct event_time_s {
       event_time_s() {
 	    count_time_events += 1;
-	    delay = 0;
+	    time = 0;
 	    start = 0;
 	    active = 0;
 	    inactive = 0;
@@ -86,7 +96,7 @@ struct event_time_s {
 	    del_thr = 0;
 	    next = NULL;
       }
-      vvp_time64_t delay;
+      vvp_time64_t time;
 
       struct event_s*start;
       struct event_s*active;
@@ -221,6 +231,7 @@ void assign_vector4_event_s::operator delete(void*dptr)
 }
 
 unsigned long count_assign4_pool(void) { return assign4_heap.pool; }
+unsigned long count_assign4_pool_used(void) { return assign4_heap.used; }
 
 struct assign_vector8_event_s  : public event_s {
       vvp_net_ptr_t ptr;
@@ -258,6 +269,7 @@ void assign_vector8_event_s::operator delete(void*dptr)
 }
 
 unsigned long count_assign8_pool() { return assign8_heap.pool; }
+unsigned long count_assign8_pool_used(void) { return assign8_heap.used; }
 
 struct assign_real_event_s  : public event_s {
       vvp_net_ptr_t ptr;
@@ -295,6 +307,7 @@ void assign_real_event_s::operator delete(void*dptr)
 }
 
 unsigned long count_assign_real_pool(void) { return assignr_heap.pool; }
+unsigned long count_assign_real_pool_used(void) { return assignr_heap.used; }
 
 struct assign_array_word_s  : public event_s {
       vvp_array_t mem;
@@ -328,6 +341,7 @@ void assign_array_word_s::operator delete(void*ptr)
 }
 
 unsigned long count_assign_aword_pool(void) { return array_w_heap.pool; }
+unsigned long count_assign_aword_pool_used(void) { return array_w_heap.used; }
 
 struct force_vector4_event_s  : public event_s {
 	/* The default constructor. */
@@ -400,6 +414,7 @@ void force_vector4_event_s::operator delete(void*dptr)
 }
 
 unsigned long count_force4_pool(void) { return force4_heap.pool; }
+unsigned long count_force4_pool_used(void) { return force4_heap.used; }
 
 /*
  * This class supports the propagation of vec4 outputs from a
@@ -489,6 +504,7 @@ void assign_array_r_word_s::operator delete(void*ptr)
 }
 
 unsigned long count_assign_arword_pool(void) { return array_r_w_heap.pool; }
+unsigned long count_assign_arword_pool_used(void) { return array_r_w_heap.used; }
 
 struct generic_event_s : public event_s {
       vvp_gen_event_t obj;
@@ -530,6 +546,7 @@ void generic_event_s::operator delete(void*ptr)
 }
 
 unsigned long count_gen_pool(void) { return generic_event_heap.pool; }
+unsigned long count_gen_pool_used(void) { return generic_event_heap.used; }
 
 /*
 ** These event_time_s will be required a lot, at high frequency.
@@ -553,13 +570,291 @@ inline void event_time_s::operator delete(void*ptr, size_t)
 }
 
 unsigned long count_time_pool(void) { return event_time_heap.pool; }
+unsigned long count_time_pool_used(void) { return event_time_heap.used; }
+
+/*
+ * The pending event_time_s cells are kept in a hierarchical timing
+ * wheel so that finding (or creating) the cell for a given time does
+ * not require walking all the pending time steps. There are
+ * WHEEL_LEVELS levels of WHEEL_SIZE slots each. A cell for time T is
+ * placed in level L, where L is the lowest level such that T and the
+ * current wheel time agree in all the bits above that level. The slot
+ * within the level is the level's bit field of T.
+ *
+ * Level 0 slots therefore hold at most one cell, for an exact time.
+ * The slots of the higher levels hold a FIFO list of cells, which may
+ * include more than one cell for the same time. These are merged (in
+ * order) when the slot is cascaded down to the lower levels, so the
+ * order of events within each queue of a time step is preserved.
+ *
+ * Cells too far in the future to fit in the wheel at all are kept in
+ * an overflow heap, ordered by time and then by creation order.
+ */
+static const unsigned WHEEL_BITS   = 8;
+static const unsigned WHEEL_SIZE   = 1U << WHEEL_BITS;
+static const unsigned WHEEL_MASK   = WHEEL_SIZE - 1;
+static const unsigned WHEEL_LEVELS = 4;
+static const unsigned WHEEL_WORD_BITS = 8 * sizeof(unsigned long);
+static const unsigned WHEEL_WORDS  = WHEEL_SIZE / WHEEL_WORD_BITS;
+
+struct wheel_slot_s {
+      struct event_time_s*head;
+      struct event_time_s*tail;
+};
+
+static struct wheel_slot_s sched_wheel[WHEEL_LEVELS][WHEEL_SIZE];
+  // Bit maps of the occupied slots of each level.
+static unsigned long sched_wheel_map[WHEEL_LEVELS][WHEEL_WORDS];
+  // The time that the wheel is positioned at. All the pending cells
+  // are at this time or later.
+static vvp_time64_t sched_wheel_now = 0;
+  // The total number of cells in the wheel and the overflow heap.
+static unsigned long sched_wheel_cells = 0;
+
+struct wheel_overflow_s {
+      vvp_time64_t time;
+      unsigned long seq;
+      struct event_time_s*cell;
+	// The heap functions build a max heap, so order by reverse time.
+      bool operator < (const wheel_overflow_s&that) const
+      {
+	    if (time != that.time) return time > that.time;
+	    return seq > that.seq;
+      }
+};
+
+static std::vector<wheel_overflow_s> sched_overflow;
+static unsigned long sched_overflow_seq = 0;
+  // The cell most recently pushed to the overflow heap, which can be
+  // reused if the next far future event is for the same time.
+static struct event_time_s*sched_overflow_last = 0;
+
+static inline unsigned wheel_index_(vvp_time64_t time, unsigned lev)
+{
+      return (time >> (lev*WHEEL_BITS)) & WHEEL_MASK;
+}
+
+static inline unsigned wheel_level_(vvp_time64_t time)
+{
+      vvp_time64_t diff = time ^ sched_wheel_now;
+      for (unsigned lev = 0 ; lev < WHEEL_LEVELS ; lev += 1) {
+	    if ((diff >> ((lev+1)*WHEEL_BITS)) == 0)
+		  return lev;
+      }
+      return WHEEL_LEVELS;
+}
+
+static inline void wheel_mark_(unsigned lev, unsigned idx)
+{
+      sched_wheel_map[lev][idx/WHEEL_WORD_BITS] |= 1UL << (idx%WHEEL_WORD_BITS);
+}
+
+static inline void wheel_unmark_(unsigned lev, unsigned idx)
+{
+      sched_wheel_map[lev][idx/WHEEL_WORD_BITS] &= ~(1UL << (idx%WHEEL_WORD_BITS));
+}
+
+/*
+ * Return the first occupied slot of the level at or after the given
+ * index, or WHEEL_SIZE if there are none.
+ */
+static unsigned wheel_find_(unsigned lev, unsigned idx)
+{
+      while (idx < WHEEL_SIZE) {
+	    unsigned long word = sched_wheel_map[lev][idx/WHEEL_WORD_BITS];
+	    word >>= idx % WHEEL_WORD_BITS;
+	    if (word == 0) {
+		  idx = (idx/WHEEL_WORD_BITS + 1) * WHEEL_WORD_BITS;
+		  continue;
+	    }
+	    while ((word & 1UL) == 0) {
+		  word >>= 1;
+		  idx += 1;
+	    }
+	    return idx;
+      }
+      return WHEEL_SIZE;
+}
+
+/*
+ * Append the events of one queue to the end of another. The queues
+ * are circular lists that point at their last event.
+ */
+static inline void append_queue_(struct event_s*&dst, struct event_s*src)
+{
+      if (src == 0) return;
+      if (dst != 0) {
+	    struct event_s*head = dst->next;
+	    dst->next = src->next;
+	    src->next = head;
+      }
+      dst = src;
+}
+
+/*
+ * Move all the events of the src cell to the end of the queues of the
+ * dst cell and delete the src cell. Both cells are for the same time.
+ */
+static void merge_event_time_(struct event_time_s*dst, struct event_time_s*src)
+{
+      assert(dst->time == src->time);
+      append_queue_(dst->start,    src->start);
+      append_queue_(dst->active,   src->active);
+      append_queue_(dst->inactive, src->inactive);
+      append_queue_(dst->nbassign, src->nbassign);
+      append_queue_(dst->rwsync,   src->rwsync);
+      append_queue_(dst->rosync,   src->rosync);
+      append_queue_(dst->del_thr,  src->del_thr);
+      delete src;
+}
+
+/*
+ * Put a cell into the wheel based on its time. If there is already a
+ * cell for that time at the end of the target slot, then merge into
+ * it. This is used both for new cells and for cascading cells down
+ * from higher levels or in from the overflow heap.
+ */
+static void wheel_place_(struct event_time_s*cell)
+{
+      count_schedule_places += 1;
+
+      unsigned lev = wheel_level_(cell->time);
+      if (lev == WHEEL_LEVELS) {
+	    wheel_overflow_s item;
+	    item.time = cell->time;
+	    item.seq  = sched_overflow_seq++;
+	    item.cell = cell;
+	    sched_overflow.push_back(item);
+	    std::push_heap(sched_overflow.begin(), sched_overflow.end());
+	    sched_overflow_last = cell;
+	    return;
+      }
+
+      unsigned idx = wheel_index_(cell->time, lev);
+      struct wheel_slot_s&slot = sched_wheel[lev][idx];
+      cell->next = 0;
+      if (slot.tail == 0) {
+	    slot.head = cell;
+	    slot.tail = cell;
+	    wheel_mark_(lev, idx);
+      } else if (slot.tail->time == cell->time) {
+	    merge_event_time_(slot.tail, cell);
+	    sched_wheel_cells -= 1;
+      } else {
+	    assert(lev > 0);
+	    slot.tail->next = cell;
+	    slot.tail = cell;
+      }
+}
 
 /*
- * This is the head of the list of pending events. This includes all
- * the events that have not been executed yet, and reaches into the
- * future.
+ * Get the cell for the given delay from the current time, making a
+ * new cell if needed.
  */
-static struct event_time_s* sched_list = 0;
+static struct event_time_s* wheel_cell_(vvp_time64_t delay)
+{
+      vvp_time64_t time = sched_wheel_now + delay;
+
+      unsigned lev = wheel_level_(time);
+      if (lev < WHEEL_LEVELS) {
+	    struct event_time_s*tail = sched_wheel[lev][wheel_index_(time, lev)].tail;
+	    if (tail && tail->time == time)
+		  return tail;
+      } else if (sched_overflow_last && sched_overflow_last->time == time) {
+	    return sched_overflow_last;
+      }
+
+      struct event_time_s*cell = new struct event_time_s;
+      cell->time = time;
+      sched_wheel_cells += 1;
+      wheel_place_(cell);
+      return cell;
+}
+
+/*
+ * Remove and return the list of cells in a slot.
+ */
+static struct event_time_s* wheel_take_(unsigned lev, unsigned idx)
+{
+      struct event_time_s*list = sched_wheel[lev][idx].head;
+      sched_wheel[lev][idx].head = 0;
+      sched_wheel[lev][idx].tail = 0;
+      wheel_unmark_(lev, idx);
+      return list;
+}
+
+/*
+ * Position the wheel at the earliest pending time and return the cell
+ * for that time. The wheel must not be empty. The cell stays in the
+ * wheel until it is released by wheel_release_().
+ */
+static struct event_time_s* wheel_next_(void)
+{
+      assert(sched_wheel_cells > 0);
+
+      for (;;) {
+	    unsigned idx = wheel_find_(0, wheel_index_(sched_wheel_now, 0));
+	    if (idx < WHEEL_SIZE) {
+		  sched_wheel_now = (sched_wheel_now & ~(vvp_time64_t)WHEEL_MASK) | idx;
+		  return sched_wheel[0][idx].head;
+	    }
+
+	      // Level 0 is empty, so find the next occupied slot of
+	      // the lowest level that has one, move the wheel to the
+	      // start of that slot and cascade its cells down.
+	    unsigned lev;
+	    for (lev = 1 ; lev < WHEEL_LEVELS ; lev += 1) {
+		  idx = wheel_find_(lev, wheel_index_(sched_wheel_now, lev) + 1);
+		  if (idx < WHEEL_SIZE) break;
+	    }
+
+	    struct event_time_s*list = 0;
+	    if (lev < WHEEL_LEVELS) {
+		  unsigned shift = lev * WHEEL_BITS;
+		  vvp_time64_t mask = ((vvp_time64_t)1 << (shift+WHEEL_BITS)) - 1;
+		  sched_wheel_now &= ~mask;
+		  sched_wheel_now |= (vvp_time64_t)idx << shift;
+		  list = wheel_take_(lev, idx);
+
+	    } else {
+		    // The wheel is empty, so jump to the earliest time
+		    // in the overflow heap and bring in all the cells
+		    // that now fit in the wheel.
+		  assert(! sched_overflow.empty());
+		  sched_wheel_now = sched_overflow.front().time;
+		  sched_overflow_last = 0;
+		  struct event_time_s*tail = 0;
+		  while (! sched_overflow.empty()
+			 && wheel_level_(sched_overflow.front().time) < WHEEL_LEVELS) {
+			struct event_time_s*cell = sched_overflow.front().cell;
+			std::pop_heap(sched_overflow.begin(), sched_overflow.end());
+			sched_overflow.pop_back();
+			cell->next = 0;
+			if (tail) tail->next = cell;
+			else list = cell;
+			tail = cell;
+		  }
+	    }
+
+	    while (list) {
+		  struct event_time_s*cell = list;
+		  list = cell->next;
+		  wheel_place_(cell);
+	    }
+      }
+}
+
+/*
+ * Remove the current (and now finished) cell from the wheel.
+ */
+static void wheel_release_(struct event_time_s*cell)
+{
+      assert(cell->time == sched_wheel_now);
+      unsigned idx = wheel_index_(sched_wheel_now, 0);
+      assert(sched_wheel[0][idx].head == cell);
+      wheel_take_(0, idx);
+      sched_wheel_cells -= 1;
+}
 
 /*
  * This is a list of initialization events. The setup puts
@@ -686,57 +981,9 @@ static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
 			    event_queue_t select_queue)
 {
       cur->next = cur;
-      struct event_time_s*ctim = sched_list;
-
-      if (sched_list == 0) {
-	      /* Is the event_time list completely empty? Create the
-		 first event_time object. */
-	    ctim = new struct event_time_s;
-	    ctim->delay = delay;
-	    ctim->next  = 0;
-	    sched_list = ctim;
-
-      } else if (sched_list->delay > delay) {
-
-	      /* Am I looking for an event before the first event_time?
-		 If so, create a new event_time to go in front. */
-	    struct event_time_s*tmp = new struct event_time_s;
-	    tmp->delay = delay;
-	    tmp->next = ctim;
-	    ctim->delay -= delay;
-	    ctim = tmp;
-	    sched_list = ctim;
+      count_schedule_inserts += 1;
 
-      } else {
-	    struct event_time_s*prev = 0;
-
-	    while (ctim->next && (ctim->delay < delay)) {
-		  delay -= ctim->delay;
-		  prev = ctim;
-		  ctim = ctim->next;
-	    }
-
-	    if (ctim->delay > delay) {
-		  struct event_time_s*tmp = new struct event_time_s;
-		  tmp->delay = delay;
-		  tmp->next  = prev->next;
-		  prev->next = tmp;
-
-		  tmp->next->delay -= delay;
-		  ctim = tmp;
-
-	    } else if (ctim->delay == delay) {
-
-	    } else {
-		  assert(ctim->next == 0);
-		  struct event_time_s*tmp = new struct event_time_s;
-		  tmp->delay = delay - ctim->delay;
-		  tmp->next = 0;
-		  ctim->next = tmp;
-
-		  ctim = tmp;
-	    }
-      }
+      struct event_time_s*ctim = wheel_cell_(delay);
 
 	/* By this point, ctim is the event_time structure that is to
 	   receive the event at hand. Put the event in to the
@@ -787,13 +1034,14 @@ static void schedule_event_(struct event_s*cur, vvp_time64_t delay,
 
 static void schedule_event_push_(struct event_s*cur)
 {
-      if ((sched_list == 0) || (sched_list->delay > 0)) {
+      struct event_time_s*ctim
+	    = sched_wheel[0][wheel_index_(sched_wheel_now, 0)].head;
+
+      if (ctim == 0) {
 	    schedule_event_(cur, 0, SEQ_ACTIVE);
 	    return;
       }
 
-      struct event_time_s*ctim = sched_list;
-
       if (ctim->active == 0) {
 	    cur->next = cur;
 	    ctim->active = cur;
@@ -860,11 +1108,121 @@ void schedule_final_vthread(vthread_t thr)
       schedule_final_event(cur);
 }
 
+/*
+ * When schedule_coalesce_nba is set, a zero delay, full width
+ * non-blocking assignment to an input that already has one pending in
+ * the nbassign queue of the current time step does not get an event
+ * of its own. Instead the new value replaces the value of the pending
+ * event, so the input receives (and propagates) only the last value.
+ *
+ * The pending events are found through a small open hash table keyed
+ * by the input. Only the events in the current nbassign queue are in
+ * the table, so it is emptied when that queue is moved to the active
+ * queue. A part select or delayed assignment to the input removes it
+ * from the table, so that its order with respect to the full width
+ * assignments is kept. Note that this does drop the intermediate
+ * values, so a zero width glitch on a register no longer wakes an
+ * edge sensitive process. That is why this is not on by default.
+ */
+bool schedule_coalesce_nba = false;
+
+struct nba_slot_s {
+      uintptr_t key;
+      struct assign_vector4_event_s*event;
+};
+
+static vector<nba_slot_s> nba_table;
+static vector<size_t> nba_table_used;
+
+static inline uintptr_t nba_key_(vvp_net_ptr_t ptr)
+{
+      return reinterpret_cast<uintptr_t>(ptr.ptr()) | ptr.port();
+}
+
+static size_t nba_slot_(uintptr_t key)
+{
+      size_t mask = nba_table.size() - 1;
+      size_t idx = key >> 2;
+      idx ^= idx >> 13;
+      idx *= 0x5bd1e995;
+      idx ^= idx >> 15;
+      for (idx &= mask ; nba_table[idx].key != 0 ; idx = (idx+1) & mask) {
+	    if (nba_table[idx].key == key)
+		  break;
+      }
+      return idx;
+}
+
+/*
+ * Return the table entry for the input, creating an empty one if
+ * needed. Keep the table at most half full.
+ */
+static struct assign_vector4_event_s*& nba_pending_(vvp_net_ptr_t ptr)
+{
+      if (2*(nba_table_used.size()+1) > nba_table.size()) {
+	    vector<nba_slot_s> old;
+	    old.swap(nba_table);
+	    nba_slot_s empty = { 0, 0 };
+	    nba_table.assign(old.empty()? 64 : 2*old.size(), empty);
+	    for (size_t idx = 0 ; idx < nba_table_used.size() ; idx += 1) {
+		  nba_slot_s&cur = old[nba_table_used[idx]];
+		  size_t slot = nba_slot_(cur.key);
+		  nba_table[slot] = cur;
+		  nba_table_used[idx] = slot;
+	    }
+      }
+
+      uintptr_t key = nba_key_(ptr);
+      size_t slot = nba_slot_(key);
+      if (nba_table[slot].key == 0) {
+	    nba_table[slot].key = key;
+	    nba_table_used.push_back(slot);
+      }
+      return nba_table[slot].event;
+}
+
+static void nba_forget_(vvp_net_ptr_t ptr)
+{
+      if (nba_table_used.empty())
+	    return;
+
+      size_t slot = nba_slot_(nba_key_(ptr));
+      nba_table[slot].event = 0;
+}
+
+static void nba_reset_(void)
+{
+      for (size_t idx = 0 ; idx < nba_table_used.size() ; idx += 1) {
+	    nba_table[nba_table_used[idx]].key = 0;
+	    nba_table[nba_table_used[idx]].event = 0;
+      }
+      nba_table_used.clear();
+}
+
 void schedule_assign_vector(vvp_net_ptr_t ptr,
 			    unsigned base, unsigned vwid,
 			    const vvp_vector4_t&bit,
 			    vvp_time64_t delay)
 {
+      if (schedule_coalesce_nba) {
+	    if (vwid == 0 && delay == 0) {
+		  struct assign_vector4_event_s*&pending = nba_pending_(ptr);
+		  if (pending) {
+			pending->val = bit;
+			count_assign_elided += 1;
+			return;
+		  }
+
+		  struct assign_vector4_event_s*cur = new struct assign_vector4_event_s(bit);
+		  cur->ptr = ptr;
+		  pending = cur;
+		  schedule_event_(cur, 0, SEQ_NBASSIGN);
+		  return;
+	    }
+
+	    nba_forget_(ptr);
+      }
+
       struct assign_vector4_event_s*cur = new struct assign_vector4_event_s(bit);
       cur->ptr = ptr;
       cur->base = base;
@@ -1165,7 +1523,7 @@ void schedule_simulate(void)
       // process events and when done run the final blocks.
       run_finals = schedule_runnable;
 
-      if (schedule_runnable) while (sched_list) {
+      if (schedule_runnable) while (sched_wheel_cells > 0) {
 
 	    if (schedule_stopped_flag) {
 		  schedule_stopped_flag = false;
@@ -1176,21 +1534,20 @@ void schedule_simulate(void)
 	    }
 
 	      /* ctim is the current time step. */
-	    struct event_time_s* ctim = sched_list;
+	    struct event_time_s* ctim = wheel_next_();
 
 	      /* If the time is advancing, then first run the
 		 postponed sync events. Run them all. */
-	    if (ctim->delay > 0) {
+	    if (ctim->time > schedule_time) {
 
 		  if (!schedule_runnable) break;
-		  schedule_time += ctim->delay;
+		  schedule_time = ctim->time;
 		    /* When the design is being traced (we are emitting
 		     * file/line information) also print any time changes. */
 		  if (show_file_line) {
 			cerr << "Advancing to simulation time: "
 			     << schedule_time << endl;
 		  }
-		  ctim->delay = 0;
 
 		  vpiNextSimTime();
 		    // Process the cbAtStartOfSimTime callbacks.
@@ -1217,6 +1574,8 @@ void schedule_simulate(void)
 		  if (ctim->active == 0) {
 			ctim->active = ctim->nbassign;
 			ctim->nbassign = 0;
+			if (! nba_table_used.empty())
+			      nba_reset_();
 
 			if (ctim->active == 0) {
 			      ctim->active = ctim->rwsync;
@@ -1227,7 +1586,7 @@ void schedule_simulate(void)
 				   deletes threads as needed. */
 			      if (ctim->active == 0) {
 				    run_rosync(ctim);
-				    sched_list = ctim->next;
+				    wheel_release_(ctim);
 				    delete ctim;
 				    continue;
 			      }
@@ -52,6 +52,13 @@ extern void schedule_assign_vector(vvp_net_ptr_t ptr,
 				   const vvp_vector4_t&val,
 				   vvp_time64_t  delay);
 
+/*
+ * Merge zero delay, full width non-blocking assignments to the same
+ * input in the same time step into a single event. This is off by
+ * default and is enabled by the -nba-coalesce extended argument.
+ */
+extern bool schedule_coalesce_nba;
+
 extern void schedule_assign_array_word(vvp_array_t mem,
 				       unsigned word_address,
 				       unsigned off,
@@ -211,6 +218,7 @@ extern void stop_handler(int rc);
  * These are event counters for the sake of performance measurements.
  */
 extern unsigned long count_assign_events;
+extern unsigned long count_assign_elided;
 extern unsigned long count_gen_events;
 extern unsigned long count_prop_events;
 extern unsigned long count_thread_events;
@@ -22,6 +22,51 @@
 
 
 # include  "config.h"
+# include  <cstddef>
+# include  <cstdlib>
+# include  <new>
+#if defined(__MINGW32__)
+# include  <malloc.h>
+#endif
+#if __cplusplus >= 201103L
+# include  <mutex>
+# define SLAB_THREAD_CACHE 1
+#endif
+
+/*
+ * A slab_t hands out fixed size items (events and the like) that it
+ * carves out of large chunks of memory.
+ *
+ * Every chunk is aligned to its own size, which is a power of 2, so
+ * the chunk that an item belongs to is found by masking the address
+ * of the item. The chunk keeps its own free list and a count of the
+ * items that are handed out. When a chunk becomes completely free
+ * and the pool holds more free items than its high water mark, the
+ * chunk is given back to the system. This keeps a burst of events
+ * (typically at time 0) from stranding its memory for the rest of the
+ * simulation.
+ *
+ * When compiled as C++11 each thread also keeps a small cache of free
+ * items in each pool, so that the common alloc/free pairs touch
+ * neither the lock nor the chunk lists. The caches are in the pool,
+ * indexed by a slot that the thread claims when it first uses a pool
+ * of this SLAB_SIZE and CHUNK_COUNT, and gives back when it exits.
+ * The cache is moved to and from the pool in batches, with the pool
+ * locked. A thread that frees items but never allocated from the
+ * pool gives them straight back, so they don't sit in its cache. So
+ * does a thread that finds all the slots taken.
+ *
+ * The pool member is the number of items in the chunks that the
+ * pool currently holds, and used is the number of those items that
+ * are handed out, including those sitting in a thread cache.
+ */
+
+template <size_t N> struct slab_ceil_pow2_ {
+      static const size_t value = 2 * slab_ceil_pow2_<(N+1)/2>::value;
+};
+template <> struct slab_ceil_pow2_<1> {
+      static const size_t value = 1;
+};
 
 template <size_t SLAB_SIZE, size_t CHUNK_COUNT> class slab_t {
 
@@ -30,6 +75,26 @@ template <size_t SLAB_SIZE, size_t CHUNK_COUNT> class slab_t {
 	    char space[SLAB_SIZE];
       };
 
+      struct chunk_s {
+	      // All the chunks of the pool.
+	    chunk_s*next;
+	    chunk_s*prev;
+	      // The chunks that still have items to hand out.
+	    chunk_s*next_free;
+	    chunk_s*prev_free;
+	      // Items that have been returned to this chunk.
+	    item_cell_u*free;
+	      // Items past this index have never been handed out.
+	    size_t fresh;
+	    size_t used;
+      };
+
+	// The chunk is rounded up to a power of 2, and the header is
+	// padded so that the items are suitably aligned.
+      static const size_t CHUNK_BYTES = slab_ceil_pow2_<SLAB_SIZE*CHUNK_COUNT>::value;
+      static const size_t HEADER_BYTES = (sizeof(chunk_s) + 15) & ~(size_t)15;
+      static const size_t ITEMS = (CHUNK_BYTES - HEADER_BYTES) / SLAB_SIZE;
+
     public:
       slab_t();
 
@@ -42,53 +107,318 @@ template <size_t SLAB_SIZE, size_t CHUNK_COUNT> class slab_t {
 #endif
 
       unsigned long pool;
+      unsigned long used;
 
     private:
-      item_cell_u*heap_;
-      item_cell_u initial_chunk_[CHUNK_COUNT];
-#ifdef CHECK_WITH_VALGRIND
-	// Each slab needs a pointer to the allocated space.
-      item_cell_u**slab_pool;
-      unsigned slab_pool_count;
+      static chunk_s* chunk_of_(void*ptr)
+      { return reinterpret_cast<chunk_s*>(reinterpret_cast<size_t>(ptr) & ~(CHUNK_BYTES-1)); }
+      static item_cell_u* item_(chunk_s*chunk, size_t idx)
+      { return reinterpret_cast<item_cell_u*>(reinterpret_cast<char*>(chunk) + HEADER_BYTES) + idx; }
+
+      void new_chunk_(void);
+      void release_chunk_(chunk_s*chunk);
+      void link_free_(chunk_s*chunk);
+      void link_empty_(chunk_s*chunk);
+      void unlink_free_(chunk_s*chunk);
+      item_cell_u* take_(void);
+      void give_(item_cell_u*cur);
+
+      chunk_s*chunks_;
+	// Chunks with free items, the completely free ones at the end.
+      chunk_s*free_chunks_;
+      chunk_s*free_tail_;
+
+#ifdef SLAB_THREAD_CACHE
+      static const size_t CACHE_BATCH = 32;
+      static const unsigned THREAD_SLOTS = 128;
+      static const unsigned NO_SLOT = THREAD_SLOTS + 1;
+
+	// The cache of one thread. It is padded to a cache line so
+	// that threads don't share lines.
+      struct thread_cache_s {
+	    item_cell_u*head;
+	    size_t count;
+	    bool alloc;
+	    char pad_[64 - sizeof(item_cell_u*) - sizeof(size_t) - sizeof(bool)];
+      };
+
+	// The slot of the thread is plain data so that getting at it
+	// is cheap: 0 before it is claimed, then the slot+1, or
+	// NO_SLOT. The guard is only touched when a slot is claimed,
+	// and gives the slot back when the thread exits.
+      struct thread_slot_guard_s {
+	    ~thread_slot_guard_s() { release_slot_(); }
+	    void touch() { }
+      };
+
+      thread_cache_s* cache_of_(void);
+      void flush_(thread_cache_s&cache, size_t cnt);
+      static unsigned claim_slot_(void);
+      static void release_slot_(void);
+
+      std::mutex lock_;
+      thread_cache_s caches_[THREAD_SLOTS];
+	// All the pools of this size, for release_slot_.
+      slab_t*next_pool_;
+
+      static std::mutex slots_lock_;
+      static bool slots_busy_[THREAD_SLOTS];
+      static slab_t*pools_;
+      static thread_local unsigned thread_slot_;
+      static thread_local thread_slot_guard_s thread_slot_guard_;
 #endif
 };
 
+#ifdef SLAB_THREAD_CACHE
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+std::mutex slab_t<SLAB_SIZE,CHUNK_COUNT>::slots_lock_;
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+bool slab_t<SLAB_SIZE,CHUNK_COUNT>::slots_busy_[THREAD_SLOTS];
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+slab_t<SLAB_SIZE,CHUNK_COUNT>* slab_t<SLAB_SIZE,CHUNK_COUNT>::pools_;
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+thread_local unsigned slab_t<SLAB_SIZE,CHUNK_COUNT>::thread_slot_;
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+thread_local typename slab_t<SLAB_SIZE,CHUNK_COUNT>::thread_slot_guard_s
+slab_t<SLAB_SIZE,CHUNK_COUNT>::thread_slot_guard_;
+#endif
+
 template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
 slab_t<SLAB_SIZE,CHUNK_COUNT>::slab_t()
 {
-      pool = CHUNK_COUNT;
-      heap_ = initial_chunk_;
-      for (unsigned idx = 0 ; idx < CHUNK_COUNT-1 ; idx += 1)
-	    initial_chunk_[idx].next = initial_chunk_+idx+1;
+      pool = 0;
+      used = 0;
+      chunks_ = 0;
+      free_chunks_ = 0;
+      free_tail_ = 0;
+#ifdef SLAB_THREAD_CACHE
+      for (unsigned idx = 0 ; idx < THREAD_SLOTS ; idx += 1) {
+	    caches_[idx].head = 0;
+	    caches_[idx].count = 0;
+	    caches_[idx].alloc = false;
+      }
+      std::lock_guard<std::mutex> guard (slots_lock_);
+      next_pool_ = pools_;
+      pools_ = this;
+#endif
+}
 
-      initial_chunk_[CHUNK_COUNT-1].next = 0;
-#ifdef CHECK_WITH_VALGRIND
-	// Initially we have no allocated space.
-      slab_pool = NULL;
-      slab_pool_count = 0;
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+void slab_t<SLAB_SIZE,CHUNK_COUNT>::link_free_(chunk_s*chunk)
+{
+      chunk->prev_free = 0;
+      chunk->next_free = free_chunks_;
+      if (free_chunks_) free_chunks_->prev_free = chunk;
+      else free_tail_ = chunk;
+      free_chunks_ = chunk;
+}
+
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+void slab_t<SLAB_SIZE,CHUNK_COUNT>::link_empty_(chunk_s*chunk)
+{
+      chunk->next_free = 0;
+      chunk->prev_free = free_tail_;
+      if (free_tail_) free_tail_->next_free = chunk;
+      else free_chunks_ = chunk;
+      free_tail_ = chunk;
+}
+
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+void slab_t<SLAB_SIZE,CHUNK_COUNT>::unlink_free_(chunk_s*chunk)
+{
+      if (chunk->prev_free) chunk->prev_free->next_free = chunk->next_free;
+      else free_chunks_ = chunk->next_free;
+      if (chunk->next_free) chunk->next_free->prev_free = chunk->prev_free;
+      else free_tail_ = chunk->prev_free;
+}
+
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+void slab_t<SLAB_SIZE,CHUNK_COUNT>::new_chunk_(void)
+{
+      void*raw;
+#if defined(__MINGW32__)
+      raw = _aligned_malloc(CHUNK_BYTES, CHUNK_BYTES);
+#else
+      if (posix_memalign(&raw, CHUNK_BYTES, CHUNK_BYTES) != 0)
+	    raw = 0;
 #endif
+      if (raw == 0)
+	    throw std::bad_alloc();
+
+	// The items are threaded onto the free list as they are first
+	// handed out, so the pages of a new chunk are not touched until
+	// they are needed.
+      chunk_s*chunk = static_cast<chunk_s*>(raw);
+      chunk->free = 0;
+      chunk->fresh = 0;
+      chunk->used = 0;
+      chunk->prev = 0;
+      chunk->next = chunks_;
+      if (chunks_) chunks_->prev = chunk;
+      chunks_ = chunk;
+      link_free_(chunk);
+      pool += ITEMS;
 }
 
 template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
-inline void* slab_t<SLAB_SIZE,CHUNK_COUNT>::alloc_slab()
+void slab_t<SLAB_SIZE,CHUNK_COUNT>::release_chunk_(chunk_s*chunk)
 {
-      if (heap_ == 0) {
-	    item_cell_u*chunk = new item_cell_u[CHUNK_COUNT];
-#ifdef CHECK_WITH_VALGRIND
-	    slab_pool_count += 1;
-	    slab_pool = (item_cell_u **) realloc(slab_pool,
-	                slab_pool_count*sizeof(item_cell_u **));
-	    slab_pool[slab_pool_count-1] = chunk;
+      unlink_free_(chunk);
+      if (chunk->prev) chunk->prev->next = chunk->next;
+      else chunks_ = chunk->next;
+      if (chunk->next) chunk->next->prev = chunk->prev;
+      pool -= ITEMS;
+#if defined(__MINGW32__)
+      _aligned_free(chunk);
+#else
+      free(chunk);
 #endif
-	    for (unsigned idx = 0 ; idx < CHUNK_COUNT ; idx += 1) {
-		  chunk[idx].next = heap_;
-		  heap_ = chunk+idx;
+}
+
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+inline typename slab_t<SLAB_SIZE,CHUNK_COUNT>::item_cell_u*
+slab_t<SLAB_SIZE,CHUNK_COUNT>::take_(void)
+{
+      if (free_chunks_ == 0)
+	    new_chunk_();
+
+      chunk_s*chunk = free_chunks_;
+      item_cell_u*cur = chunk->free;
+      if (cur) {
+	    chunk->free = cur->next;
+      } else {
+	    cur = item_(chunk, chunk->fresh);
+	    chunk->fresh += 1;
+      }
+      chunk->used += 1;
+      used += 1;
+      if (chunk->free == 0 && chunk->fresh == ITEMS)
+	    unlink_free_(chunk);
+
+      return cur;
+}
+
+/*
+ * Return an item to its chunk. A chunk that becomes empty moves to
+ * the end of the list of free chunks, so that the items are handed
+ * out of partly used chunks first and empty chunks stay empty. The
+ * last empty chunk is released while the pool would still have at
+ * least a chunk's worth of free items, or half the number of items
+ * in use, whichever is more. That slack keeps a pool that hovers
+ * around a chunk boundary from allocating and releasing the same
+ * chunk over and over.
+ */
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+inline void slab_t<SLAB_SIZE,CHUNK_COUNT>::give_(item_cell_u*cur)
+{
+      chunk_s*chunk = chunk_of_(cur);
+      bool was_full = chunk->free == 0 && chunk->fresh == ITEMS;
+
+      cur->next = chunk->free;
+      chunk->free = cur;
+      chunk->used -= 1;
+      used -= 1;
+
+      if (chunk->used == 0) {
+	    if (chunk != free_tail_) {
+		  if (! was_full) unlink_free_(chunk);
+		  link_empty_(chunk);
 	    }
-	    pool += CHUNK_COUNT;
+      } else if (was_full) {
+	    link_free_(chunk);
+      }
+
+      if (free_tail_->used == 0) {
+	    unsigned long high_water = used/2 > ITEMS? used/2 : ITEMS;
+	    if (pool - used - ITEMS >= high_water)
+		  release_chunk_(free_tail_);
+      }
+}
+
+#ifdef SLAB_THREAD_CACHE
+
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+unsigned slab_t<SLAB_SIZE,CHUNK_COUNT>::claim_slot_(void)
+{
+      std::lock_guard<std::mutex> guard (slots_lock_);
+      thread_slot_ = NO_SLOT;
+      for (unsigned idx = 0 ; idx < THREAD_SLOTS ; idx += 1) {
+	    if (slots_busy_[idx]) continue;
+	    slots_busy_[idx] = true;
+	    thread_slot_ = idx + 1;
+	    thread_slot_guard_.touch();
+	    break;
       }
+      return thread_slot_;
+}
 
-      item_cell_u*cur = heap_;
-      heap_ = heap_->next;
+/*
+ * The thread is exiting, so give the items in its caches back to the
+ * pools and free its slot for the next thread.
+ */
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+void slab_t<SLAB_SIZE,CHUNK_COUNT>::release_slot_(void)
+{
+      unsigned slot = thread_slot_;
+      if (slot == 0 || slot == NO_SLOT) return;
+
+      std::lock_guard<std::mutex> guard (slots_lock_);
+      for (slab_t*cur = pools_ ; cur ; cur = cur->next_pool_) {
+	    thread_cache_s&cache = cur->caches_[slot-1];
+	    cur->flush_(cache, cache.count);
+	    cache.alloc = false;
+      }
+      slots_busy_[slot-1] = false;
+      thread_slot_ = 0;
+}
+
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+inline typename slab_t<SLAB_SIZE,CHUNK_COUNT>::thread_cache_s*
+slab_t<SLAB_SIZE,CHUNK_COUNT>::cache_of_(void)
+{
+      unsigned slot = thread_slot_;
+      if (slot == 0) slot = claim_slot_();
+      return slot == NO_SLOT? 0 : caches_ + slot - 1;
+}
+
+/*
+ * Give cnt items of the thread cache back to the pool.
+ */
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+void slab_t<SLAB_SIZE,CHUNK_COUNT>::flush_(thread_cache_s&cache, size_t cnt)
+{
+      std::lock_guard<std::mutex> guard (lock_);
+      for ( ; cnt > 0 ; cnt -= 1) {
+	    item_cell_u*cur = cache.head;
+	    cache.head = cur->next;
+	    cache.count -= 1;
+	    give_(cur);
+      }
+}
+
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+inline void* slab_t<SLAB_SIZE,CHUNK_COUNT>::alloc_slab()
+{
+      thread_cache_s*cache = cache_of_();
+      if (cache == 0) {
+	    std::lock_guard<std::mutex> guard (lock_);
+	    return take_();
+      }
+
+      if (cache->head == 0) {
+	    std::lock_guard<std::mutex> guard (lock_);
+	    for (size_t idx = 0 ; idx < CACHE_BATCH ; idx += 1) {
+		  item_cell_u*cur = take_();
+		  cur->next = cache->head;
+		  cache->head = cur;
+	    }
+	    cache->count += CACHE_BATCH;
+	    cache->alloc = true;
+      }
+
+      item_cell_u*cur = cache->head;
+      cache->head = cur->next;
+      cache->count -= 1;
       return cur;
 }
 
@@ -96,20 +426,61 @@ template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
 inline void slab_t<SLAB_SIZE,CHUNK_COUNT>::free_slab(void*ptr)
 {
       item_cell_u*cur = reinterpret_cast<item_cell_u*> (ptr);
-      cur->next = heap_;
-      heap_ = cur;
+      thread_cache_s*cache = cache_of_();
+      if (cache == 0 || ! cache->alloc) {
+	    std::lock_guard<std::mutex> guard (lock_);
+	    give_(cur);
+	    return;
+      }
+
+      cur->next = cache->head;
+      cache->head = cur;
+      cache->count += 1;
+      if (cache->count > 2*CACHE_BATCH)
+	    flush_(*cache, CACHE_BATCH);
+}
+
+#else
+
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+inline void* slab_t<SLAB_SIZE,CHUNK_COUNT>::alloc_slab()
+{
+      return take_();
 }
 
+template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
+inline void slab_t<SLAB_SIZE,CHUNK_COUNT>::free_slab(void*ptr)
+{
+      give_(reinterpret_cast<item_cell_u*> (ptr));
+}
+
+#endif
+
 #ifdef CHECK_WITH_VALGRIND
 template <size_t SLAB_SIZE, size_t CHUNK_COUNT>
 inline void slab_t<SLAB_SIZE,CHUNK_COUNT>::delete_pool(void)
 {
-      for (unsigned idx = 0; idx < slab_pool_count; idx += 1) {
-	    delete [] slab_pool[idx];
+#ifdef SLAB_THREAD_CACHE
+	// The caches only hold items of this pool, and those are all
+	// about to go away.
+      std::lock_guard<std::mutex> guard (slots_lock_);
+      for (unsigned idx = 0 ; idx < THREAD_SLOTS ; idx += 1) {
+	    caches_[idx].head = 0;
+	    caches_[idx].count = 0;
+      }
+#endif
+      while (chunks_) {
+	    chunk_s*next = chunks_->next;
+#if defined(__MINGW32__)
+	    _aligned_free(chunks_);
+#else
+	    free(chunks_);
+#endif
+	    chunks_ = next;
       }
-      free(slab_pool);
-      slab_pool = NULL;
-      slab_pool_count = 0;
+      free_chunks_ = 0;
+      pool = 0;
+      used = 0;
 }
 #endif
 
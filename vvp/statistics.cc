@@ -18,11 +18,18 @@
  */
 
 # include  "statistics.h"
+# if __cplusplus >= 201103L
+# include  <chrono>
+# else
+# include  <ctime>
+# endif
 
 /*
  * This is a count of the instruction opcodes that were created.
  */
 unsigned long count_opcodes = 0;
+  // The number of opcode sequences replaced with fused instructions.
+unsigned long count_opcodes_fused = 0;
 
 unsigned long count_functors = 0;
 unsigned long count_functors_logic = 0;
@@ -31,9 +38,37 @@ unsigned long count_functors_resolv= 0;
 unsigned long count_functors_sig   = 0;
 
 unsigned long count_filters = 0;
+
+unsigned long count_vec4_checked = 0;
+unsigned long count_vec4_suppressed = 0;
 unsigned long count_vpi_nets = 0;
 
 unsigned long count_vpi_scopes = 0;
 
 size_t size_opcodes = 0;
 
+unsigned long count_resolv_deferred = 0;
+unsigned long count_resolv_waits = 0;
+
+double time_load_parse = 0.0;
+double time_load_link = 0.0;
+double time_load_symbols = 0.0;
+double time_load_finish = 0.0;
+double time_load_compiletf = 0.0;
+
+double load_clock_lap(void)
+{
+# if __cplusplus >= 201103L
+      typedef std::chrono::steady_clock clock_type;
+      static clock_type::time_point last = clock_type::now();
+      clock_type::time_point now = clock_type::now();
+      double res = std::chrono::duration<double>(now - last).count();
+# else
+	/* Without a portable wall clock, use the processor time. */
+      static clock_t last = clock();
+      clock_t now = clock();
+      double res = (double)(now - last) / CLOCKS_PER_SEC;
+# endif
+      last = now;
+      return res;
+}
@@ -27,6 +27,7 @@
 #endif
 
 extern unsigned long count_opcodes;
+extern unsigned long count_opcodes_fused;
 extern unsigned long count_functors;
 extern unsigned long count_functors_logic;
 extern unsigned long count_functors_bufif;
@@ -34,6 +35,11 @@ extern unsigned long count_functors_resolv;
 extern unsigned long count_functors_sig;
 extern unsigned long count_filters;
 extern unsigned long count_vvp_nets;
+  // The vec4 values that reached a functor that checks its input for
+  // a change, and how many of those it dropped because the input did
+  // not change. The rest were delivered.
+extern unsigned long count_vec4_checked;
+extern unsigned long count_vec4_suppressed;
 extern unsigned long count_vpi_nets;
 extern unsigned long count_vpi_scopes;
 
@@ -46,20 +52,49 @@ extern unsigned long count_real_array_words;
 
 
 extern unsigned long count_time_events;
+  // The event pools report the items that they hold and how many of
+  // those are in use (see slab.h).
 extern unsigned long count_time_pool(void);
+extern unsigned long count_time_pool_used(void);
+extern unsigned long count_schedule_inserts;
+extern unsigned long count_schedule_places;
 
 extern unsigned long count_assign_events;
+extern unsigned long count_assign_elided;
 extern unsigned long count_assign4_pool(void);
+extern unsigned long count_assign4_pool_used(void);
 extern unsigned long count_assign8_pool(void);
+extern unsigned long count_assign8_pool_used(void);
 extern unsigned long count_assign_real_pool(void);
+extern unsigned long count_assign_real_pool_used(void);
 extern unsigned long count_assign_aword_pool(void);
+extern unsigned long count_assign_aword_pool_used(void);
 extern unsigned long count_assign_arword_pool(void);
+extern unsigned long count_assign_arword_pool_used(void);
+extern unsigned long count_force4_pool(void);
+extern unsigned long count_force4_pool_used(void);
 
 extern unsigned long count_gen_events;
 extern unsigned long count_gen_pool(void);
+extern unsigned long count_gen_pool_used(void);
 
 extern size_t size_opcodes;
 extern size_t size_vvp_nets;
+
+  // The references that were still unresolved when the design was
+  // linked, and how many times those had to wait for their label.
+extern unsigned long count_resolv_deferred;
+extern unsigned long count_resolv_waits;
+
+  // The seconds spent in each phase of loading the design. The
+  // load_clock_lap function returns the wall clock seconds since it
+  // was last called.
+extern double time_load_parse;
+extern double time_load_link;
+extern double time_load_symbols;
+extern double time_load_finish;
+extern double time_load_compiletf;
+extern double load_clock_lap(void);
 extern size_t size_vvp_net_funs;
 
 #endif /* IVL_statistics_H */
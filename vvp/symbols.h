@@ -63,19 +63,21 @@ class symbol_table_s {
       void sym_set_value(const char*key, symbol_value_t val);
 
 	// This method locates the value in the symbol table and returns
-	// it. If the value does not exist, create it, initialize it with
-	// zero and return the zero value.
-      symbol_value_t sym_get_value(const char*key);
+	// it. If the key does not exist, return a zero value.
+      symbol_value_t sym_get_value(const char*key) const;
 
     private:
       symbol_table_s(const symbol_table_s&) { assert(0); };
-      struct tree_node_*root;
+	// The table is open addressed with linear probing, and the
+	// number of slots is a power of 2.
+      struct symbol_slot_*slots_;
+      unsigned mask_;
+      unsigned used_;
       struct key_strings*str_chunk;
       unsigned str_used;
 
-      symbol_value_t find_value_(struct tree_node_*cur,
-				 const char*key, symbol_value_t val,
-				 bool force_flag);
+      struct symbol_slot_*find_slot_(const char*key, unsigned hash) const;
+      void grow_();
       char*key_strdup_(const char*str);
 };
 
@@ -108,7 +110,7 @@ template <class T> class symbol_map_s : private symbol_table_s {
 	symbol_table_s::sym_set_value(key, tmp);
       }
 
-      T* sym_get_value(const char*key)
+      T* sym_get_value(const char*key) const
       { symbol_value_t val = symbol_table_s::sym_get_value(key);
 	return reinterpret_cast<T*>(val.ptr);
       }
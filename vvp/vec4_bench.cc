@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * This is a micro-benchmark for the vector kernels in vec4_kernels.cc.
+ * It runs every kernel of every kernel set that this processor can
+ * use across a range of vector widths, checks that all the sets get
+ * the same results, and prints the time per call in nanoseconds.
+ * It is built and run by "make bench".
+ */
+
+# include  "vec4_kernels.h"
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <ctime>
+# include  <vector>
+
+using namespace std;
+
+static const unsigned BITS_PER_WORD = 8*sizeof(unsigned long);
+static const unsigned MAX_WORDS = 4096 / (8*sizeof(unsigned long));
+
+/* Enough calls that the widest vectors take a measurable time. */
+static const unsigned long WORDS_PER_RUN = 64*1024*1024;
+
+enum kernel_e { K_AND, K_OR, K_EEQ, K_EQ_XZ, K_ANY, K_OR_INTO, K_SCAN, K_COUNT };
+static const char*kernel_names[K_COUNT] = {
+      "and", "or", "eeq", "eq_xz", "any", "or_into", "scan"
+};
+
+static unsigned long random_word(void)
+{
+      unsigned long res = 0;
+      for (unsigned idx = 0 ; idx < sizeof(unsigned long) ; idx += 1)
+	    res = (res << 8) | (rand() & 0xff);
+      return res;
+}
+
+struct operands_s {
+      unsigned long a[MAX_WORDS], b[MAX_WORDS];
+      unsigned long ta[MAX_WORDS], tb[MAX_WORDS];
+};
+
+/*
+ * Run the kernel once on a copy of the operands, and return a checksum
+ * of everything it produced so that the kernel sets can be compared.
+ */
+static unsigned long run_once(const vec4_kernels_s*set, kernel_e kern,
+			      const operands_s&src, unsigned words)
+{
+      operands_s op = src;
+      unsigned long sum = 0;
+      vec4_scan_s scan;
+      memset(&scan, 0, sizeof scan);
+
+      switch (kern) {
+	  case K_AND:
+	    set->and_words(op.a, op.b, op.ta, op.tb, words);
+	    break;
+	  case K_OR:
+	    set->or_words(op.a, op.b, op.ta, op.tb, words);
+	    break;
+	  case K_EEQ:
+	    sum = set->eeq_words(op.a, op.b, op.ta, op.tb, words);
+	    break;
+	  case K_EQ_XZ:
+	    sum = set->eq_xz_words(op.a, op.b, op.ta, op.tb, words);
+	    break;
+	  case K_ANY:
+	    sum = set->any_words(op.b, words);
+	    break;
+	  case K_OR_INTO:
+	    set->or_into_words(op.a, op.b, words);
+	    break;
+	  case K_SCAN:
+	    set->scan_words(op.a, op.b, words, scan);
+	    sum = scan.zeros ^ (scan.ones<<1) ^ (scan.xz<<2) ^ (scan.parity<<3);
+	    break;
+	  default:
+	    break;
+      }
+
+      for (unsigned idx = 0 ; idx < words ; idx += 1)
+	    sum = sum*31 + (op.a[idx] ^ (op.b[idx] << 1));
+      return sum;
+}
+
+static double time_kernel(const vec4_kernels_s*set, kernel_e kern,
+			  operands_s&op, unsigned words)
+{
+      unsigned long calls = WORDS_PER_RUN / words;
+      unsigned long sink = 0;
+      clock_t start = clock();
+      for (unsigned long cnt = 0 ; cnt < calls ; cnt += 1) {
+	    switch (kern) {
+		case K_AND:
+		  set->and_words(op.a, op.b, op.ta, op.tb, words);
+		  break;
+		case K_OR:
+		  set->or_words(op.a, op.b, op.ta, op.tb, words);
+		  break;
+		case K_EEQ:
+		  sink += set->eeq_words(op.a, op.b, op.ta, op.tb, words);
+		  break;
+		case K_EQ_XZ:
+		  sink += set->eq_xz_words(op.a, op.b, op.ta, op.tb, words);
+		  break;
+		case K_ANY:
+		  sink += set->any_words(op.b, words);
+		  break;
+		case K_OR_INTO:
+		  set->or_into_words(op.a, op.b, words);
+		  break;
+		case K_SCAN: {
+		      vec4_scan_s scan;
+		      memset(&scan, 0, sizeof scan);
+		      set->scan_words(op.a, op.b, words, scan);
+		      sink += scan.parity;
+		      break;
+		}
+		default:
+		  break;
+	    }
+      }
+      clock_t end = clock();
+      if (sink == 1) fprintf(stderr, " ");
+      return (double)(end - start) / CLOCKS_PER_SEC * 1e9 / calls;
+}
+
+int main(int, char*[])
+{
+      vector<const vec4_kernels_s*> sets;
+      sets.push_back(&vec4_kernels_portable);
+      vec4_kernels_select();
+      if (vec4_kernels != &vec4_kernels_portable)
+	    sets.push_back(vec4_kernels);
+
+      operands_s src;
+      srand(1);
+      for (unsigned idx = 0 ; idx < MAX_WORDS ; idx += 1) {
+	    src.a[idx] = random_word();
+	    src.b[idx] = random_word() & random_word() & random_word();
+      }
+	// The comparison kernels are timed on equal operands, so that
+	// they have to look at all the words.
+      memcpy(src.ta, src.a, sizeof src.a);
+      memcpy(src.tb, src.b, sizeof src.b);
+
+	// Also check the results on operands that differ near the end.
+      operands_s diff = src;
+      for (unsigned idx = MAX_WORDS/2 ; idx < MAX_WORDS ; idx += 1) {
+	    diff.ta[idx] = random_word();
+	    diff.tb[idx] = random_word() & random_word();
+      }
+
+      int errors = 0;
+
+      printf("%-8s %6s", "kernel", "width");
+      for (unsigned idx = 0 ; idx < sets.size() ; idx += 1)
+	    printf(" %10s", sets[idx]->name);
+      printf("  (ns/call)\n");
+
+      for (unsigned kern = 0 ; kern < K_COUNT ; kern += 1) {
+	    for (unsigned width = 128 ; width <= 4096 ; width *= 2) {
+		  unsigned words = width / BITS_PER_WORD;
+
+		  unsigned long check = run_once(sets[0], (kernel_e)kern,
+						 src, words);
+		  unsigned long check_diff = run_once(sets[0], (kernel_e)kern,
+						      diff, words);
+		  for (unsigned idx = 1 ; idx < sets.size() ; idx += 1) {
+			if (run_once(sets[idx], (kernel_e)kern, src, words) != check
+			    || run_once(sets[idx], (kernel_e)kern, diff, words) != check_diff) {
+			      printf("%s: %s kernel differs at width %u\n",
+				     sets[idx]->name, kernel_names[kern], width);
+			      errors += 1;
+			}
+		  }
+
+		  printf("%-8s %6u", kernel_names[kern], width);
+		  for (unsigned idx = 0 ; idx < sets.size() ; idx += 1) {
+			operands_s op = src;
+			printf(" %10.2f", time_kernel(sets[idx], (kernel_e)kern,
+						      op, words));
+		  }
+		  printf("\n");
+	    }
+      }
+
+      return errors? 1 : 0;
+}
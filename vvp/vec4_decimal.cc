@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "vec4_decimal.h"
+# include  <climits>
+# include  <stdint.h>
+
+/*
+ * The words are worked on in 32 bit pieces so that every product or
+ * partial dividend fits in a uint64_t, whatever the size of a long.
+ * The base is the largest power of ten that fits in a piece.
+ */
+static const uint32_t BASE = 1000000000;
+static const unsigned BDIGITS = 9;
+
+static const uint32_t pow10[BDIGITS+1] = {
+      1, 10, 100, 1000, 10000, 100000, 1000000, 10000000,
+      100000000, 1000000000
+};
+
+#if ULONG_MAX > 0xffffffffUL
+static const unsigned BITS_PER_WORD = 64;
+#else
+static const unsigned BITS_PER_WORD = 32;
+#endif
+
+/*
+ * Divide the words in place by BASE and return the remainder. The
+ * remainder is always less than BASE, so shifting it up to make the
+ * next partial dividend cannot overflow.
+ */
+static uint32_t div_base(unsigned long*words, unsigned nwords)
+{
+      uint64_t rem = 0;
+      for (unsigned idx = nwords ; idx > 0 ; idx -= 1) {
+	    unsigned long word = words[idx-1];
+#if ULONG_MAX > 0xffffffffUL
+	    uint64_t hi = (rem << 32) | (word >> 32);
+	    uint64_t lo = ((hi % BASE) << 32) | (word & 0xffffffffUL);
+	    words[idx-1] = ((hi / BASE) << 32) | (lo / BASE);
+	    rem = lo % BASE;
+#else
+	    uint64_t cur = (rem << 32) | word;
+	    words[idx-1] = (unsigned long) (cur / BASE);
+	    rem = cur % BASE;
+#endif
+      }
+      return (uint32_t) rem;
+}
+
+/*
+ * Multiply the first used words by mul and add add, carrying into
+ * the next word if there is room, and return the new number of used
+ * words. A carry out of the last word is dropped.
+ */
+static unsigned mul_add(unsigned long*words, unsigned nwords, unsigned used,
+			uint32_t mul, uint32_t add)
+{
+      uint64_t carry = add;
+      for (unsigned idx = 0 ; idx < used ; idx += 1) {
+	    unsigned long word = words[idx];
+#if ULONG_MAX > 0xffffffffUL
+	    uint64_t lo = (word & 0xffffffffUL) * (uint64_t)mul + carry;
+	    uint64_t hi = (word >> 32) * (uint64_t)mul + (lo >> 32);
+	    words[idx] = (hi << 32) | (lo & 0xffffffffUL);
+	    carry = hi >> 32;
+#else
+	    uint64_t cur = word * (uint64_t)mul + carry;
+	    words[idx] = (unsigned long) cur;
+	    carry = cur >> 32;
+#endif
+      }
+      if (carry != 0 && used < nwords) {
+	    words[used] = (unsigned long) carry;
+	    used += 1;
+      }
+      return used;
+}
+
+/*
+ * Write the digits of val into buf backwards, least significant
+ * first. If pad is set, write exactly BDIGITS digits.
+ */
+static char* put_digits_rev(char*buf, uint64_t val, bool pad)
+{
+      if (pad) {
+	    for (unsigned idx = 0 ; idx < BDIGITS ; idx += 1) {
+		  *buf++ = '0' + (char)(val % 10);
+		  val /= 10;
+	    }
+      } else {
+	    do {
+		  *buf++ = '0' + (char)(val % 10);
+		  val /= 10;
+	    } while (val != 0);
+      }
+      return buf;
+}
+
+unsigned vec4_words_to_dec(char*buf, unsigned long*words, unsigned nwords)
+{
+      while (nwords > 0 && words[nwords-1] == 0)
+	    nwords -= 1;
+
+      char*cp = buf;
+
+	// Peel off nine digits at a time until what is left fits in
+	// 64 bits. The top word can only become zero after a division.
+      while (nwords*BITS_PER_WORD > 64) {
+	    uint32_t rem = div_base(words, nwords);
+	    cp = put_digits_rev(cp, rem, true);
+	    while (words[nwords-1] == 0)
+		  nwords -= 1;
+      }
+
+      uint64_t val = 0;
+      for (unsigned idx = nwords ; idx > 0 ; idx -= 1) {
+#if ULONG_MAX > 0xffffffffUL
+	    val = words[idx-1];
+#else
+	    val = (val << 32) | words[idx-1];
+#endif
+      }
+      cp = put_digits_rev(cp, val, false);
+
+	// The digits came out backwards, so turn them around.
+      unsigned ndigits = cp - buf;
+      for (unsigned idx = 0 ; idx < ndigits/2 ; idx += 1) {
+	    char tmp = buf[idx];
+	    buf[idx] = buf[ndigits-idx-1];
+	    buf[ndigits-idx-1] = tmp;
+      }
+
+      return ndigits;
+}
+
+void vec4_dec_to_words(unsigned long*words, unsigned nwords,
+		       const char*digits, unsigned ndigits)
+{
+      for (unsigned idx = 0 ; idx < nwords ; idx += 1)
+	    words[idx] = 0;
+
+      unsigned count = 0;
+      for (unsigned idx = 0 ; idx < ndigits ; idx += 1) {
+	    if (digits[idx] != '_')
+		  count += 1;
+      }
+
+	// Take the digits in groups of BDIGITS, with the short group
+	// first so that the rest line up.
+      unsigned group = count % BDIGITS;
+      if (group == 0)
+	    group = BDIGITS;
+
+      unsigned used = 0;
+      unsigned have = 0;
+      uint32_t chunk = 0;
+      for (unsigned idx = 0 ; idx < ndigits ; idx += 1) {
+	    if (digits[idx] == '_')
+		  continue;
+
+	    chunk = chunk*10 + (digits[idx] - '0');
+	    have += 1;
+	    if (have < group)
+		  continue;
+
+	    used = mul_add(words, nwords, used, pow10[group], chunk);
+	    group = BDIGITS;
+	    have = 0;
+	    chunk = 0;
+      }
+}
@@ -0,0 +1,57 @@
+#ifndef IVL_vec4_decimal_H
+#define IVL_vec4_decimal_H
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "config.h"
+
+/*
+ * These are the radix conversion loops behind vpip_vec4_to_dec_str
+ * and vpip_dec_str_to_vec4. They work on plain unsigned binary
+ * values held in arrays of words, least significant word first, so
+ * the caller takes care of X/Z bits and of the sign.
+ *
+ * The conversions go a word at a time in base 10^9, so a value of N
+ * bits takes about (N/32)^2/2 word operations instead of the N^2/9
+ * digit operations of converting a bit at a time. Values of 64 bits
+ * or fewer are converted directly.
+ */
+
+/*
+ * Write the value of the nwords words as decimal digits, most
+ * significant first and without leading zeros, into buf, and return
+ * the number of digits written. A zero value is written as "0". The
+ * string is not terminated, and the words are used as scratch space
+ * and so are clobbered. The buffer must have room for all the
+ * digits, which is at most one more than log10(2) times the number
+ * of bits in the words.
+ */
+extern unsigned vec4_words_to_dec(char*buf, unsigned long*words,
+				  unsigned nwords);
+
+/*
+ * Set the nwords words to the value of the ndigits characters of
+ * digits, which are decimal digits, most significant first, possibly
+ * mixed with '_' characters that are skipped. A value too large for
+ * the words is truncated to the low bits.
+ */
+extern void vec4_dec_to_words(unsigned long*words, unsigned nwords,
+			      const char*digits, unsigned ndigits);
+
+#endif /* IVL_vec4_decimal_H */
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "vec4_kernels.h"
+#ifdef HAVE_VEC4_KERNELS_AVX2
+# include  <immintrin.h>
+#endif
+
+/*
+ * The portable kernels. These are the loops that used to be written
+ * out in the vvp_vector4_t methods, see there for the truth tables.
+ */
+
+static void and_words_portable(unsigned long*a, unsigned long*b,
+			       const unsigned long*ta, const unsigned long*tb,
+			       unsigned cnt)
+{
+      for (unsigned idx = 0 ; idx < cnt ; idx += 1) {
+	    unsigned long tmp1 = a[idx] | b[idx];
+	    unsigned long tmp2 = ta[idx] | tb[idx];
+	    a[idx] = tmp1 & tmp2;
+	    b[idx] = (tmp1 & tb[idx]) | (tmp2 & b[idx]);
+      }
+}
+
+static void or_words_portable(unsigned long*a, unsigned long*b,
+			      const unsigned long*ta, const unsigned long*tb,
+			      unsigned cnt)
+{
+      for (unsigned idx = 0 ; idx < cnt ; idx += 1) {
+	    unsigned long tmp = a[idx] | b[idx] | ta[idx] | tb[idx];
+	    b[idx] = ((~a[idx] | b[idx]) & tb[idx]) |
+		     ((~ta[idx] | tb[idx]) & b[idx]);
+	    a[idx] = tmp;
+      }
+}
+
+static bool eeq_words_portable(const unsigned long*a, const unsigned long*b,
+			       const unsigned long*ta, const unsigned long*tb,
+			       unsigned cnt)
+{
+      for (unsigned idx = 0 ; idx < cnt ; idx += 1) {
+	    if (a[idx] != ta[idx])
+		  return false;
+	    if (b[idx] != tb[idx])
+		  return false;
+      }
+      return true;
+}
+
+static bool eq_xz_words_portable(const unsigned long*a, const unsigned long*b,
+				 const unsigned long*ta, const unsigned long*tb,
+				 unsigned cnt)
+{
+      for (unsigned idx = 0 ; idx < cnt ; idx += 1) {
+	    if ((a[idx]|b[idx]) != (ta[idx]|tb[idx]))
+		  return false;
+	    if (b[idx] != tb[idx])
+		  return false;
+      }
+      return true;
+}
+
+static bool any_words_portable(const unsigned long*b, unsigned cnt)
+{
+      for (unsigned idx = 0 ; idx < cnt ; idx += 1) {
+	    if (b[idx])
+		  return true;
+      }
+      return false;
+}
+
+static void or_into_words_portable(unsigned long*a, const unsigned long*b,
+				   unsigned cnt)
+{
+      for (unsigned idx = 0 ; idx < cnt ; idx += 1)
+	    a[idx] |= b[idx];
+}
+
+static void scan_words_portable(const unsigned long*a, const unsigned long*b,
+				unsigned cnt, vec4_scan_s&res)
+{
+      for (unsigned idx = 0 ; idx < cnt ; idx += 1) {
+	    res.zeros  |= ~(a[idx] | b[idx]);
+	    res.ones   |= a[idx] & ~b[idx];
+	    res.xz     |= b[idx];
+	    res.parity ^= a[idx];
+      }
+}
+
+const vec4_kernels_s vec4_kernels_portable = {
+      "portable",
+      and_words_portable,
+      or_words_portable,
+      eeq_words_portable,
+      eq_xz_words_portable,
+      any_words_portable,
+      or_into_words_portable,
+      scan_words_portable
+};
+
+#ifdef HAVE_VEC4_KERNELS_AVX2
+
+/*
+ * The AVX2 kernels work on 256 bits at a time, and finish any odd
+ * words at the end with the portable kernel. The vectors are not
+ * necessarily aligned, so use unaligned loads and stores.
+ *
+ * The compiler does not reliably clear the upper halves of the AVX
+ * registers before a tail call, and the SSE code of the portable
+ * kernel is very slow if they are dirty, so do it explicitly.
+ */
+# define AVX2_TARGET __attribute__((target("avx2")))
+
+static const unsigned AVX2_WORDS = 32 / sizeof(unsigned long);
+
+AVX2_TARGET static inline __m256i load_(const unsigned long*ptr)
+{
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+}
+
+AVX2_TARGET static inline void store_(unsigned long*ptr, __m256i val)
+{
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), val);
+}
+
+AVX2_TARGET static void and_words_avx2(unsigned long*a, unsigned long*b,
+				       const unsigned long*ta,
+				       const unsigned long*tb, unsigned cnt)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX2_WORDS <= cnt ; idx += AVX2_WORDS) {
+	    __m256i va = load_(a+idx), vb = load_(b+idx);
+	    __m256i vta = load_(ta+idx), vtb = load_(tb+idx);
+	    __m256i tmp1 = _mm256_or_si256(va, vb);
+	    __m256i tmp2 = _mm256_or_si256(vta, vtb);
+	    store_(a+idx, _mm256_and_si256(tmp1, tmp2));
+	    store_(b+idx, _mm256_or_si256(_mm256_and_si256(tmp1, vtb),
+					  _mm256_and_si256(tmp2, vb)));
+      }
+      _mm256_zeroupper();
+      and_words_portable(a+idx, b+idx, ta+idx, tb+idx, cnt-idx);
+}
+
+AVX2_TARGET static void or_words_avx2(unsigned long*a, unsigned long*b,
+				      const unsigned long*ta,
+				      const unsigned long*tb, unsigned cnt)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX2_WORDS <= cnt ; idx += AVX2_WORDS) {
+	    __m256i va = load_(a+idx), vb = load_(b+idx);
+	    __m256i vta = load_(ta+idx), vtb = load_(tb+idx);
+	    __m256i tmp = _mm256_or_si256(_mm256_or_si256(va, vb),
+					  _mm256_or_si256(vta, vtb));
+	      // (~a | b) & tb  ==  (~a & tb) | (b & tb)
+	    __m256i lft = _mm256_or_si256(_mm256_andnot_si256(va, vtb),
+					  _mm256_and_si256(vb, vtb));
+	    __m256i rgt = _mm256_or_si256(_mm256_andnot_si256(vta, vb),
+					  _mm256_and_si256(vtb, vb));
+	    store_(b+idx, _mm256_or_si256(lft, rgt));
+	    store_(a+idx, tmp);
+      }
+      _mm256_zeroupper();
+      or_words_portable(a+idx, b+idx, ta+idx, tb+idx, cnt-idx);
+}
+
+AVX2_TARGET static bool eeq_words_avx2(const unsigned long*a,
+				       const unsigned long*b,
+				       const unsigned long*ta,
+				       const unsigned long*tb, unsigned cnt)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX2_WORDS <= cnt ; idx += AVX2_WORDS) {
+	    __m256i diff = _mm256_or_si256(
+		  _mm256_xor_si256(load_(a+idx), load_(ta+idx)),
+		  _mm256_xor_si256(load_(b+idx), load_(tb+idx)));
+	    if (! _mm256_testz_si256(diff, diff))
+		  return false;
+      }
+      _mm256_zeroupper();
+      return eeq_words_portable(a+idx, b+idx, ta+idx, tb+idx, cnt-idx);
+}
+
+AVX2_TARGET static bool eq_xz_words_avx2(const unsigned long*a,
+					 const unsigned long*b,
+					 const unsigned long*ta,
+					 const unsigned long*tb, unsigned cnt)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX2_WORDS <= cnt ; idx += AVX2_WORDS) {
+	    __m256i vb = load_(b+idx), vtb = load_(tb+idx);
+	    __m256i diff = _mm256_or_si256(
+		  _mm256_xor_si256(_mm256_or_si256(load_(a+idx), vb),
+				   _mm256_or_si256(load_(ta+idx), vtb)),
+		  _mm256_xor_si256(vb, vtb));
+	    if (! _mm256_testz_si256(diff, diff))
+		  return false;
+      }
+      _mm256_zeroupper();
+      return eq_xz_words_portable(a+idx, b+idx, ta+idx, tb+idx, cnt-idx);
+}
+
+AVX2_TARGET static bool any_words_avx2(const unsigned long*b, unsigned cnt)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX2_WORDS <= cnt ; idx += AVX2_WORDS) {
+	    __m256i vb = load_(b+idx);
+	    if (! _mm256_testz_si256(vb, vb))
+		  return true;
+      }
+      _mm256_zeroupper();
+      return any_words_portable(b+idx, cnt-idx);
+}
+
+AVX2_TARGET static void or_into_words_avx2(unsigned long*a,
+					   const unsigned long*b,
+					   unsigned cnt)
+{
+      unsigned idx = 0;
+      for ( ; idx+AVX2_WORDS <= cnt ; idx += AVX2_WORDS)
+	    store_(a+idx, _mm256_or_si256(load_(a+idx), load_(b+idx)));
+      _mm256_zeroupper();
+      or_into_words_portable(a+idx, b+idx, cnt-idx);
+}
+
+AVX2_TARGET static void scan_words_avx2(const unsigned long*a,
+					const unsigned long*b,
+					unsigned cnt, vec4_scan_s&res)
+{
+      __m256i zeros  = _mm256_setzero_si256();
+      __m256i ones   = _mm256_setzero_si256();
+      __m256i xz     = _mm256_setzero_si256();
+      __m256i parity = _mm256_setzero_si256();
+      __m256i all1   = _mm256_set1_epi32(-1);
+
+      unsigned idx = 0;
+      for ( ; idx+AVX2_WORDS <= cnt ; idx += AVX2_WORDS) {
+	    __m256i va = load_(a+idx), vb = load_(b+idx);
+	    zeros  = _mm256_or_si256(zeros, _mm256_andnot_si256(_mm256_or_si256(va, vb), all1));
+	    ones   = _mm256_or_si256(ones, _mm256_andnot_si256(vb, va));
+	    xz     = _mm256_or_si256(xz, vb);
+	    parity = _mm256_xor_si256(parity, va);
+      }
+
+	// Fold the lanes into the result words.
+      unsigned long tmp[4][AVX2_WORDS];
+      store_(tmp[0], zeros);
+      store_(tmp[1], ones);
+      store_(tmp[2], xz);
+      store_(tmp[3], parity);
+      for (unsigned lane = 0 ; lane < AVX2_WORDS ; lane += 1) {
+	    res.zeros  |= tmp[0][lane];
+	    res.ones   |= tmp[1][lane];
+	    res.xz     |= tmp[2][lane];
+	    res.parity ^= tmp[3][lane];
+      }
+
+	// Finish the odd words here rather than in the portable
+	// kernel, so that there is no AVX/SSE transition on the way.
+      for ( ; idx < cnt ; idx += 1) {
+	    res.zeros  |= ~(a[idx] | b[idx]);
+	    res.ones   |= a[idx] & ~b[idx];
+	    res.xz     |= b[idx];
+	    res.parity ^= a[idx];
+      }
+}
+
+const vec4_kernels_s vec4_kernels_avx2 = {
+      "avx2",
+      and_words_avx2,
+      or_words_avx2,
+      eeq_words_avx2,
+      eq_xz_words_avx2,
+      any_words_avx2,
+      or_into_words_avx2,
+      scan_words_avx2
+};
+
+#endif
+
+const vec4_kernels_s*vec4_kernels = &vec4_kernels_portable;
+
+void vec4_kernels_select(void)
+{
+#ifdef HAVE_VEC4_KERNELS_AVX2
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2")) {
+	    vec4_kernels = &vec4_kernels_avx2;
+	    return;
+      }
+#endif
+      vec4_kernels = &vec4_kernels_portable;
+}
@@ -0,0 +1,88 @@
+#ifndef IVL_vec4_kernels_H
+#define IVL_vec4_kernels_H
+/*
+ * Copyright (c) 2026 The Icarus Verilog developers
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "config.h"
+
+/*
+ * These are the inner loops of the vvp_vector4_t methods that work
+ * on the split abit/bbit word arrays of wide vectors. The kernels
+ * only ever see whole words; the caller takes care of masking the
+ * unused bits of the last word where that matters.
+ *
+ * There is a portable version of every kernel, and on x86 hosts an
+ * AVX2 version that is selected at run time if the processor has
+ * it. The results are bit-for-bit the same.
+ */
+
+/*
+ * The scan kernel collects what the reduction operators need to
+ * know about the bits of a vector: whether there are any 0, 1 or
+ * X/Z bits, and the XOR of all the abits.
+ */
+struct vec4_scan_s {
+      unsigned long zeros;
+      unsigned long ones;
+      unsigned long xz;
+      unsigned long parity;
+};
+
+struct vec4_kernels_s {
+      const char*name;
+	// a/b &= ta/tb and a/b |= ta/tb in the 4-value sense.
+      void (*and_words)(unsigned long*a, unsigned long*b,
+			const unsigned long*ta, const unsigned long*tb,
+			unsigned cnt);
+      void (*or_words)(unsigned long*a, unsigned long*b,
+		       const unsigned long*ta, const unsigned long*tb,
+		       unsigned cnt);
+	// Exact (===) and X/Z-as-equal comparisons.
+      bool (*eeq_words)(const unsigned long*a, const unsigned long*b,
+			const unsigned long*ta, const unsigned long*tb,
+			unsigned cnt);
+      bool (*eq_xz_words)(const unsigned long*a, const unsigned long*b,
+			  const unsigned long*ta, const unsigned long*tb,
+			  unsigned cnt);
+	// True if any bit of the words is set.
+      bool (*any_words)(const unsigned long*b, unsigned cnt);
+	// a |= b
+      void (*or_into_words)(unsigned long*a, const unsigned long*b,
+			    unsigned cnt);
+	// Accumulate (or for parity, xor) the words into res.
+      void (*scan_words)(const unsigned long*a, const unsigned long*b,
+			 unsigned cnt, vec4_scan_s&res);
+};
+
+extern const vec4_kernels_s vec4_kernels_portable;
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+# define HAVE_VEC4_KERNELS_AVX2 1
+extern const vec4_kernels_s vec4_kernels_avx2;
+#endif
+
+/*
+ * The kernels that the runtime uses. This starts out as the portable
+ * set, and vec4_kernels_select() switches it to the best set that
+ * the processor supports.
+ */
+extern const vec4_kernels_s*vec4_kernels;
+extern void vec4_kernels_select(void);
+
+#endif /* IVL_vec4_kernels_H */
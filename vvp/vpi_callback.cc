@@ -37,6 +37,7 @@
 # include  <cstdio>
 # include  <cassert>
 # include  <cstdlib>
+# include  <vector>
 
 using namespace std;
 
@@ -279,6 +280,224 @@ static value_callback* make_value_change(p_cb_data data)
       return obj;
 }
 
+/*
+ * A value record callback (_cbValueRecord) sits in the value callback
+ * list of its object like any value change callback, but a change does
+ * not call into the VPI module. Instead the callback adds itself to
+ * the record_list of the time step and tells the object that it is
+ * not ready. The first record of a time step also schedules the
+ * record_flush event in the read only synch queue, and that event
+ * collects the values of all the listed objects and passes them to
+ * the callback routines in as few calls as possible.
+ */
+struct value_record_flush_s : public vvp_gen_event_s {
+      ~value_record_flush_s() { }
+      void run_run();
+};
+
+static vector<value_record_source*> record_list;
+static value_record_flush_s record_flush;
+
+value_record_source::value_record_source(value_callback*c, unsigned w)
+: cb(c), wid(w), queued(false)
+{
+}
+
+value_record_source::~value_record_source()
+{
+      if (! queued)
+	    return;
+
+      for (unsigned idx = 0 ; idx < record_list.size() ; idx += 1) {
+	    if (record_list[idx] == this)
+		  record_list[idx] = 0;
+      }
+}
+
+void value_record_source::queue(void)
+{
+      if (queued)
+	    return;
+
+      if (record_list.empty())
+	    schedule_generic(&record_flush, 0, true, true);
+      record_list.push_back(this);
+      queued = true;
+}
+
+void value_record_flush_s::run_run()
+{
+      static vector<value_record_source*> group;
+      static vector<s_vpi_value_record> records;
+      static vector<s_vpi_vecval> words;
+
+      struct t_vpi_time now;
+      now.type = vpiSimTime;
+      vpip_time_to_timestruct(&now, schedule_simtime());
+
+      for (unsigned idx = 0 ; idx < record_list.size() ; idx += 1) {
+	    if (record_list[idx] == 0)
+		  continue;
+
+	      // Gather the rest of the list that goes to the same
+	      // routine. There is usually only the one dumper.
+	    PLI_INT32 (*cb_rtn)(struct t_cb_data*) = record_list[idx]->cb->cb_data.cb_rtn;
+	    size_t nwords = 0;
+	    group.clear();
+	    for (unsigned jdx = idx ; jdx < record_list.size() ; jdx += 1) {
+		  value_record_source*cur = record_list[jdx];
+		  if (cur == 0 || cur->cb->cb_data.cb_rtn != cb_rtn)
+			continue;
+		  cur->queued = false;
+		  record_list[jdx] = 0;
+		  group.push_back(cur);
+		  nwords += (cur->wid + 31) / 32;
+	    }
+
+	      // Removed callbacks are reaped by their object.
+	    if (cb_rtn == 0)
+		  continue;
+
+	    records.resize(group.size());
+	    words.resize(nwords);
+	    nwords = 0;
+	    for (unsigned jdx = 0 ; jdx < group.size() ; jdx += 1) {
+		  value_record_source*cur = group[jdx];
+		  s_vpi_value_record&rec = records[jdx];
+		  rec.obj = cur->cb->cb_data.obj;
+		  rec.user_data = cur->cb->cb_data.user_data;
+		  rec.size = cur->wid;
+		  if (cur->wid == 0) {
+			rec.value.real = cur->get_real();
+		  } else {
+			vvp_vector4_t tmp;
+			cur->get_vec4(tmp);
+			assert(tmp.size() == cur->wid);
+			rec.value.vector = &words[nwords];
+			tmp.get_vecval(rec.value.vector);
+			nwords += (cur->wid + 31) / 32;
+		  }
+	    }
+
+	    s_vpi_value value;
+	    value.format = _vpiRecordVal;
+	    value.value.misc = reinterpret_cast<char*>(&records[0]);
+
+	    struct t_cb_data data;
+	    data.reason = _cbValueRecord;
+	    data.cb_rtn = cb_rtn;
+	    data.obj = 0;
+	    data.time = &now;
+	    data.value = &value;
+	    data.index = group.size();
+	    data.user_data = 0;
+
+	    assert(vpi_mode_flag == VPI_MODE_NONE);
+	    vpi_mode_flag = VPI_MODE_ROSYNC;
+	    (cb_rtn)(&data);
+	    vpi_mode_flag = VPI_MODE_NONE;
+      }
+
+      record_list.clear();
+}
+
+/*
+ * The value record callback of a variable or net that a signal filter
+ * holds.
+ */
+class value_record_callback : public value_callback, public value_record_source {
+    public:
+      value_record_callback(p_cb_data data, vvp_signal_value*sig,
+			    unsigned wid);
+
+      bool test_value_callback_ready(void);
+      void get_vec4(vvp_vector4_t&val);
+      double get_real(void);
+
+    private:
+      vvp_signal_value*sig_;
+};
+
+value_record_callback::value_record_callback(p_cb_data data,
+					     vvp_signal_value*s, unsigned w)
+: value_callback(data), value_record_source(this, w), sig_(s)
+{
+}
+
+bool value_record_callback::test_value_callback_ready(void)
+{
+      queue();
+      return false;
+}
+
+void value_record_callback::get_vec4(vvp_vector4_t&val)
+{
+      sig_->vec4_value(val);
+}
+
+double value_record_callback::get_real(void)
+{
+      return sig_->real_value();
+}
+
+/*
+ * Make a value record callback for the object. This works for the
+ * variables and nets that a signal filter holds and for the words of
+ * variable arrays. For anything else return nil so that the caller
+ * can use a value change callback instead.
+ */
+static value_callback* make_value_record(p_cb_data data)
+{
+      assert(data->obj);
+      if (vpi_get(vpiAutomatic, data->obj))
+	    return 0;
+
+      vvp_net_t*net;
+      unsigned wid;
+      switch (data->obj->get_type_code()) {
+
+	  case vpiReg:
+	  case vpiNet:
+	  case vpiIntegerVar:
+	  case vpiBitVar:
+	  case vpiByteVar:
+	  case vpiShortIntVar:
+	  case vpiIntVar:
+	  case vpiLongIntVar: {
+	    __vpiSignal*sig = dynamic_cast<__vpiSignal*>(data->obj);
+	    assert(sig);
+	    net = sig->node;
+	    wid = sig->width();
+	    if (wid == 0)
+		  return 0;
+	    break;
+	  }
+
+	  case vpiRealVar: {
+	    __vpiRealVar*rfp = dynamic_cast<__vpiRealVar*>(data->obj);
+	    assert(rfp);
+	    net = rfp->net;
+	    wid = 0;
+	    break;
+	  }
+
+	  case vpiMemoryWord:
+	    return vpip_array_word_record(data);
+
+	  default:
+	    return 0;
+      }
+
+      vvp_signal_value*sig_val = dynamic_cast<vvp_signal_value*>(net->fil);
+      vvp_vpi_callback*sig_cb = dynamic_cast<vvp_vpi_callback*>(net->fil);
+      if (sig_val == 0 || sig_cb == 0)
+	    return 0;
+
+      value_callback*obj = new value_record_callback(data, sig_val, wid);
+      sig_cb->add_vpi_callback(obj);
+      return obj;
+}
+
 class sync_callback : public __vpiCallback {
     public:
       explicit sync_callback(p_cb_data data);
@@ -630,6 +849,10 @@ vpiHandle vpi_register_cb(p_cb_data data)
 	    obj = make_value_change(data);
 	    break;
 
+	  case _cbValueRecord:
+	    obj = make_value_record(data);
+	    break;
+
 	  case cbReadOnlySynch:
 	    obj = make_sync(data, true);
 	    break;
@@ -786,7 +1009,7 @@ void vvp_vpi_callback::run_vpi_callbacks()
 
       while (next) {
 	    value_callback*cur = next;
-	    next = dynamic_cast<value_callback*>(cur->next);
+	    next = static_cast<value_callback*>(cur->next);
 
 	    if (cur->cb_data.cb_rtn != 0) {
 		  if (cur->test_value_callback_ready()) {
@@ -48,27 +48,63 @@ extern FILE* vpi_trace;
 typedef struct mcd_entry {
 	FILE *fp;
 	char *filename;
+	char *buffer;
 } mcd_entry_s;
 static mcd_entry_s mcd_table[31];
 static mcd_entry_s *fd_table = NULL;
 static unsigned fd_table_len = 0;
 
 static FILE* logfile;
+static char* logfile_buffer = NULL;
+
+/*
+ * With the -log-buffer=<size> extended argument every file that is
+ * opened gets a fully buffered stream with a buffer of this size, so
+ * that a busy $fdisplay does not turn into a write for each line. The
+ * buffers are flushed by $fflush, $stop and on exit. Whatever is still
+ * in a buffer is lost if vvp dies on a signal.
+ */
+static size_t buffer_size = 0;
+
+static void set_buffer(mcd_entry_s *ent)
+{
+      ent->buffer = NULL;
+      if (buffer_size == 0) return;
+
+      ent->buffer = (char *) malloc(buffer_size);
+      setvbuf(ent->fp, ent->buffer, _IOFBF, buffer_size);
+}
+
+static void close_entry(mcd_entry_s *ent, int &rc, int err)
+{
+      if (fclose(ent->fp)) rc |= err;
+      free(ent->filename);
+      free(ent->buffer);
+      ent->fp = NULL;
+      ent->filename = NULL;
+      ent->buffer = NULL;
+}
 
 /* Initialize mcd portion of vpi.  Must be called before
- * any vpi_mcd routines can be used.
+ * any vpi_mcd routines can be used. With a buffer size, the standard
+ * output (unless buffer_stdout is false) and the log file are given
+ * fully buffered streams as well.
  */
-void vpip_mcd_init(FILE *log)
+void vpip_mcd_init(FILE *log, size_t buf_size, bool buffer_stdout)
 {
       fd_table_len = FD_INCR;
       fd_table = (mcd_entry_s *) malloc(fd_table_len*sizeof(mcd_entry_s));
       for (unsigned idx = 0; idx < fd_table_len; idx += 1) {
 	    fd_table[idx].fp = NULL;
 	    fd_table[idx].filename = NULL;
+	    fd_table[idx].buffer = NULL;
       }
 
+      buffer_size = buf_size;
+
       mcd_table[0].fp = stdout;
       mcd_table[0].filename = strdup("stdout");
+      if (buffer_stdout) set_buffer(&mcd_table[0]);
 
       fd_table[0].fp = stdin;
       fd_table[0].filename = strdup("stdin");
@@ -78,11 +114,36 @@ void vpip_mcd_init(FILE *log)
       fd_table[2].filename = strdup("stderr");
 
       logfile = log;
+      if (buffer_size > 0 && logfile && logfile != stderr) {
+	    logfile_buffer = (char *) malloc(buffer_size);
+	    setvbuf(logfile, logfile_buffer, _IOFBF, buffer_size);
+      }
 }
 
 #ifdef CHECK_WITH_VALGRIND
 void vpi_mcd_delete(void)
 {
+      int rc = 0;
+      for (unsigned idx = 1; idx < 31; idx += 1) {
+	    if (mcd_table[idx].fp) close_entry(&mcd_table[idx], rc, 0);
+      }
+      for (unsigned idx = 3; idx < fd_table_len; idx += 1) {
+	    if (fd_table[idx].fp) close_entry(&fd_table[idx], rc, 0);
+      }
+
+      if (logfile && logfile != stderr) fclose(logfile);
+      logfile = NULL;
+      free(logfile_buffer);
+      logfile_buffer = NULL;
+
+	/* Detach the buffer from stdout, which stays open. */
+      if (mcd_table[0].buffer) {
+	    fflush(stdout);
+	    setvbuf(stdout, NULL, _IONBF, 0);
+	    free(mcd_table[0].buffer);
+	    mcd_table[0].buffer = NULL;
+      }
+
       free(mcd_table[0].filename);
       mcd_table[0].filename = NULL;
       mcd_table[0].fp = NULL;
@@ -117,10 +178,7 @@ extern "C" PLI_UINT32 vpi_mcd_close(PLI_UINT32 mcd)
 	    for(int i = 1; i < 31; i++) {
 		  if ((mcd>>i) & 1) {
 			if (mcd_table[i].fp) {
-			      if (fclose(mcd_table[i].fp)) rc |= 1<<i;
-			      free(mcd_table[i].filename);
-			      mcd_table[i].fp = NULL;
-			      mcd_table[i].filename = NULL;
+			      close_entry(&mcd_table[i], rc, 1<<i);
 			} else {
 			      rc |= 1<<i;
 			}
@@ -129,10 +187,7 @@ extern "C" PLI_UINT32 vpi_mcd_close(PLI_UINT32 mcd)
       } else {
 	    unsigned idx = FD_IDX(mcd);
 	    if (idx > 2 && idx < fd_table_len && fd_table[idx].fp) {
-		  if (fclose(fd_table[idx].fp)) rc = mcd;
-		  free(fd_table[idx].filename);
-		  fd_table[idx].fp = NULL;
-		  fd_table[idx].filename = NULL;
+		  close_entry(&fd_table[idx], rc, mcd);
 	    } else rc = mcd;
       }
       return rc;
@@ -175,6 +230,7 @@ got_entry:
 	if(mcd_table[i].fp == NULL)
 		return 0;
 	mcd_table[i].filename = strdup(name);
+	set_buffer(&mcd_table[i]);
 
 	if (vpi_trace) {
 	      fprintf(vpi_trace, "vpi_mcd_open(%s) --> 0x%08x\n",
@@ -305,6 +361,7 @@ extern "C" PLI_INT32 vpi_fopen(const char*name, const char*mode)
       for (unsigned idx = i; idx < fd_table_len; idx += 1) {
 	    fd_table[idx].fp = NULL;
 	    fd_table[idx].filename = NULL;
+	    fd_table[idx].buffer = NULL;
       }
 
 got_entry:
@@ -318,6 +375,7 @@ got_entry:
 #endif
       if (fd_table[i].fp == NULL) return 0;
       fd_table[i].filename = strdup(name);
+      set_buffer(&fd_table[i]);
       return ((1U<<31)|i);
 }
 
@@ -1028,6 +1028,10 @@ void vpip_put_value_event::run_run()
 	  case vpiVectorVal:
 	    free(value.value.vector);
 	    break;
+	    /* Free the copied raw vector and its words. */
+	  case _vpiRawVectorVal:
+	    free(value.value.misc);
+	    break;
 	    /* Free the copied strength structure. */
 	  case vpiStrengthVal:
 	    free(value.value.strength);
@@ -1059,6 +1063,24 @@ static t_vpi_vecval *vectordup(t_vpi_vecval *val, PLI_INT32 size)
       return rtn;
 }
 
+/* Make a copy of a raw vector structure. The words are kept in the
+ * same allocation so that a single free releases everything. */
+static char *rawvectordup(const s_vpi_raw_vector *val)
+{
+      const unsigned word_bytes = sizeof(unsigned long);
+      unsigned words = (val->size + 8*word_bytes - 1) / (8*word_bytes);
+      unsigned head = (sizeof(s_vpi_raw_vector) + word_bytes - 1) / word_bytes;
+      unsigned long *buf = static_cast<unsigned long *>
+	    (malloc((head + 2*words) * word_bytes));
+      s_vpi_raw_vector *rtn = reinterpret_cast<s_vpi_raw_vector *>(buf);
+      rtn->size = val->size;
+      memcpy(buf + head, val->aval, words * word_bytes);
+      memcpy(buf + head + words, val->bval, words * word_bytes);
+      rtn->aval = buf + head;
+      rtn->bval = buf + head + words;
+      return reinterpret_cast<char *>(rtn);
+}
+
 /* Make a copy of a pointer to a strength structure. */
 static t_vpi_strengthval *strengthdup(t_vpi_strengthval *val)
 {
@@ -1108,6 +1130,12 @@ vpiHandle vpi_put_value(vpiHandle obj, s_vpi_value*vp,
 		  break;
 	    }
 
+	    if (vp && vp->format == _vpiRawArrayVal) {
+		  fprintf(stderr, "VPI error: the _vpiRawArrayVal format "
+				  "can only be put with vpiNoDelay.\n");
+		  return 0;
+	    }
+
 	    if ((dly == 0) && schedule_at_rosync()) {
 		  fprintf(stderr, "VPI error: attempted to put a value to "
 				  "variable '%s' during a read-only synch "
@@ -1144,6 +1172,11 @@ vpiHandle vpi_put_value(vpiHandle obj, s_vpi_value*vp,
 		  put->value.value.vector = vectordup(put->value.value.vector,
 		                                      vpi_get(vpiSize, obj));
 		  break;
+		  /* Copy a raw vector and its words. */
+		case _vpiRawVectorVal:
+		  put->value.value.misc = rawvectordup(
+		      reinterpret_cast<s_vpi_raw_vector *>(put->value.value.misc));
+		  break;
 		  /* Copy a strength pointer item. */
 		case vpiStrengthVal:
 		  put->value.value.strength =
@@ -204,6 +204,30 @@ class value_callback : public __vpiCallback {
       struct t_vpi_value cb_value;
 };
 
+/*
+ * A value record callback (_cbValueRecord) is a value_callback that
+ * is also derived from this class. When its object changes it calls
+ * queue() instead of the callback routine, and at the end of the time
+ * step the queued records are passed to their routines in batches,
+ * with the values that get_vec4() or get_real() return.
+ */
+class value_record_source {
+    public:
+      value_record_source(value_callback*cb, unsigned wid);
+      virtual ~value_record_source();
+
+      void queue(void);
+
+      virtual void get_vec4(vvp_vector4_t&val) = 0;
+      virtual double get_real(void) = 0;
+
+    public:
+      value_callback*cb;
+	// The vector width, or 0 if this is a real value.
+      unsigned wid;
+      bool queued;
+};
+
 extern void callback_execute(struct __vpiCallback*cur);
 
 struct __vpiSystemTime : public __vpiHandle {
@@ -689,6 +713,8 @@ struct __vpiArray : public __vpiArrayBase, public __vpiHandle {
       vpiHandle vpi_handle(int code);
       inline vpiHandle vpi_iterate(int code) { return vpi_array_base_iterate(code); }
       vpiHandle vpi_index(int idx);
+      void vpi_get_value(p_vpi_value val);
+      vpiHandle vpi_put_value(p_vpi_value val, int flags);
 
       void set_word(unsigned idx, unsigned off, const vvp_vector4_t&val);
       void set_word(unsigned idx, double val);
@@ -700,6 +726,13 @@ struct __vpiArray : public __vpiArrayBase, public __vpiHandle {
       void get_word_obj(unsigned address, vvp_object_t&val);
       std::string get_word_str(unsigned address);
 
+	// Bulk access to the words of a variable array, see
+	// vvp_vector4array_t::set_words().
+      void set_words(unsigned address, unsigned count,
+		     const unsigned long*abits, const unsigned long*bbits);
+      void get_words(unsigned address, unsigned count,
+		     unsigned long*abits, unsigned long*bbits);
+
       void alias_word(unsigned long addr, vpiHandle word, int msb, int lsb);
       void attach_word(unsigned addr, vpiHandle word);
       void word_change(unsigned long addr);
@@ -722,6 +755,8 @@ struct __vpiArray : public __vpiArrayBase, public __vpiHandle {
       bool swap_addr;
 
 private:
+      long raw_array_address(const s_vpi_raw_array*raw);
+
       unsigned array_count;
       __vpiScope*scope;
 
@@ -496,6 +496,20 @@ static void format_vpiVectorVal(vvp_signal_value*sig, int base, unsigned wid,
                          need_result_buf(hwid * sizeof(s_vpi_vecval), RBUF_VAL);
       vp->value.vector = op;
 
+	/* The whole value can be cut straight out of the vector
+	   words without looking at each bit. */
+      if (base == 0 && wid == sig->value_size()) {
+	    const vvp_vector4_t*ptr = sig->vec4_value_ptr();
+	    if (ptr) {
+		  ptr->get_vecval(op);
+	    } else {
+		  vvp_vector4_t tmp;
+		  sig->vec4_value(tmp);
+		  tmp.get_vecval(op);
+	    }
+	    return;
+      }
+
       op->aval = op->bval = 0;
       for (long idx = base ;  idx < end ;  idx += 1) {
 	    if (base >= 0 && base < (signed)sig->value_size()) {
@@ -532,6 +546,39 @@ static void format_vpiVectorVal(vvp_signal_value*sig, int base, unsigned wid,
       }
 }
 
+/*
+ * The _vpiRawVectorVal format hands out the vector words of the
+ * signal itself when the signal keeps its value in one vector, and
+ * otherwise a copy of the words in the result buffer.
+ */
+static void format_vpiRawVectorVal(vvp_signal_value*sig, s_vpi_value*vp)
+{
+      const unsigned long word_bytes = sizeof(unsigned long);
+      const vvp_vector4_t*ptr = sig->vec4_value_ptr();
+      unsigned words = ptr? 0 : (sig->value_size() + 8*word_bytes - 1) / (8*word_bytes);
+      unsigned head = (sizeof(s_vpi_raw_vector) + word_bytes - 1) / word_bytes;
+
+      unsigned long*buf = (unsigned long*)
+	    need_result_buf((head + 2*words) * word_bytes, RBUF_VAL);
+      s_vpi_raw_vector*raw = (s_vpi_raw_vector*)buf;
+      raw->size = sig->value_size();
+      vp->value.misc = (char*)raw;
+
+      if (ptr) {
+	    ptr->get_words(raw->aval, raw->bval);
+	    return;
+      }
+
+      vvp_vector4_t tmp;
+      sig->vec4_value(tmp);
+      const unsigned long*ap, *bp;
+      tmp.get_words(ap, bp);
+      memcpy(buf + head, ap, words * word_bytes);
+      memcpy(buf + head + words, bp, words * word_bytes);
+      raw->aval = buf + head;
+      raw->bval = buf + head + words;
+}
+
 /*
  * implement vpi_get for vpiReg objects.
  */
@@ -884,6 +931,10 @@ static void signal_get_value(vpiHandle ref, s_vpi_value*vp)
 	    format_vpiRealVal(vsig, 0, wid, rfp->signed_flag, vp);
 	    break;
 
+	  case _vpiRawVectorVal:
+	    format_vpiRawVectorVal(vsig, vp);
+	    break;
+
 	  case vpiObjTypeVal:
 	    if (wid == 1) {
 		  vp->format = vpiScalarVal;
@@ -998,16 +1049,19 @@ vvp_vector4_t vec4_from_vpi_value(s_vpi_value*vp, unsigned wid)
 	  }
 
 	  case vpiVectorVal:
-	    for (unsigned idx = 0 ;  idx < wid ;  idx += 1) {
-		  unsigned long aval = vp->value.vector[idx/32].aval;
-		  unsigned long bval = vp->value.vector[idx/32].bval;
-		  aval >>= idx%32;
-		  bval >>= idx%32;
-		  int bitmask = (aval&1) | ((bval<<1)&2);
-		  vvp_bit4_t bit = scalar_to_bit4(bitmask);
-		  val.set_bit(idx, bit);
-	    }
+	    val.set_vecval(vp->value.vector);
 	    break;
+	  case _vpiRawVectorVal: {
+		const s_vpi_raw_vector*raw = (const s_vpi_raw_vector*)vp->value.misc;
+		if (raw->size >= (PLI_INT32)wid) {
+		      val.set_words(raw->aval, raw->bval);
+		} else if (raw->size > 0) {
+		      vvp_vector4_t tmp (raw->size);
+		      tmp.set_words(raw->aval, raw->bval);
+		      val.set_vec(0, tmp);
+		}
+		break;
+	  }
 	  case vpiBinStrVal:
 	    vpip_bin_str_to_vec4(val, vp->value.str);
 	    break;
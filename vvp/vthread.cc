@@ -118,7 +118,10 @@ struct vthread_s {
       inline vvp_vector4_t pop_vec4(void)
       {
 	    assert(! stack_vec4_.empty());
-	    vvp_vector4_t val = stack_vec4_.back();
+	      // Take the value off the stack without copying the
+	      // word arrays of wide vectors.
+	    vvp_vector4_t val;
+	    val.swap(stack_vec4_.back());
 	    stack_vec4_.pop_back();
 	    return val;
       }
@@ -126,6 +129,12 @@ struct vthread_s {
       {
 	    stack_vec4_.push_back(val);
       }
+# if __cplusplus >= 201103L
+      inline void push_vec4(vvp_vector4_t&&val)
+      {
+	    stack_vec4_.push_back(std::move(val));
+      }
+# endif
       inline const vvp_vector4_t& peek_vec4(unsigned depth)
       {
 	    unsigned size = stack_vec4_.size();
@@ -1375,17 +1384,18 @@ bool of_ASSIGN_WRE(vthread_t thr, vvp_code_t cp)
 bool of_BLEND(vthread_t thr, vvp_code_t)
 {
       vvp_vector4_t vala = thr->pop_vec4();
-      vvp_vector4_t valb = thr->pop_vec4();
+      vvp_vector4_t&valb = thr->peek_vec4();
       assert(vala.size() == valb.size());
 
+	// Blend into the stack entry in place. Where the bits are
+	// the same it already holds the result.
       for (unsigned idx = 0 ; idx < vala.size() ; idx += 1) {
 	    if (vala.value(idx) == valb.value(idx))
 		  continue;
 
-	    vala.set_bit(idx, BIT4_X);
+	    valb.set_bit(idx, BIT4_X);
       }
 
-      thr->push_vec4(vala);
       return true;
 }
 
@@ -3701,6 +3711,77 @@ bool of_JMP1XZ(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+/*
+ * These are the fused instructions that codespace_fuse() substitutes
+ * for the first opcode of common sequences. The operands of the later
+ * instructions are read from the (unchanged) instructions that follow
+ * in the code space, and the net effect on the thread, including the
+ * flags, is the same as executing the sequence. The vec4 stack is not
+ * touched because the intermediate values never escape the sequence.
+ */
+
+/*
+ * %cmpi/e <vala>, <valb>, <wid>
+ * %jmp/0xz <pc>, <flag>
+ */
+bool of_CMPIE_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      vvp_code_t jmp = cp + 1;
+
+      of_CMPIE(thr, cp);
+
+      thr->pc = jmp + 1;
+      return of_JMP0XZ(thr, jmp);
+}
+
+/*
+ * %load/vec4 <net>
+ * %cmpi/e <vala>, <valb>, <wid>
+ * %jmp/0xz <pc>, <flag>
+ */
+bool of_LOAD_VEC4_CMPIE_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (cp->net->fil);
+      if (sig == 0)
+	    return of_LOAD_VEC4(thr, cp);
+
+      vvp_code_t cmp = cp + 1;
+      vvp_code_t jmp = cp + 2;
+
+      vvp_vector4_t lval;
+      sig->vec4_value(lval);
+
+      vvp_vector4_t rval (cmp->number, BIT4_0);
+      get_immediate_rval(cmp, rval);
+
+      do_CMPE(thr, lval, rval);
+
+      thr->pc = jmp + 1;
+      return of_JMP0XZ(thr, jmp);
+}
+
+/*
+ * %load/vec4 <net>
+ * %flag_set/vec4 <flag>
+ * %jmp/0xz <pc>, <flag>
+ */
+bool of_LOAD_VEC4_FLAG_JMP0XZ(vthread_t thr, vvp_code_t cp)
+{
+      vvp_signal_value*sig = dynamic_cast<vvp_signal_value*> (cp->net->fil);
+      if (sig == 0 || sig->value_size() == 0)
+	    return of_LOAD_VEC4(thr, cp);
+
+      vvp_code_t flag = cp + 1;
+      vvp_code_t jmp  = cp + 2;
+
+      int use_flag = flag->number;
+      assert(use_flag < vthread_s::FLAGS_COUNT);
+      thr->flags[use_flag] = sig->value(0);
+
+      thr->pc = jmp + 1;
+      return of_JMP0XZ(thr, jmp);
+}
+
 /*
  * The %join instruction causes the thread to wait for one child
  * to die.  If a child is already dead (and a zombie) then I reap
@@ -4578,25 +4659,8 @@ bool of_NOOP(vthread_t, vvp_code_t)
  */
 bool of_NORR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_1;
-
-      for (unsigned idx = 0 ;  idx < val.size() ;  idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1) {
-		  lb = BIT4_0;
-		  break;
-	    }
-
-	    if (rb != BIT4_0)
-		  lb = BIT4_X;
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
-
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, ~val.reduce_or());
       return true;
 }
 
@@ -4615,24 +4679,8 @@ bool of_NULL(vthread_t thr, vvp_code_t)
  */
 bool of_ANDR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_1;
-
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_0) {
-		  lb = BIT4_0;
-		  break;
-	    }
-
-	    if (rb != 1)
-		  lb = BIT4_X;
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
-
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, val.reduce_and());
       return true;
 }
 
@@ -4641,24 +4689,8 @@ bool of_ANDR(vthread_t thr, vvp_code_t)
  */
 bool of_NANDR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_0;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_0) {
-		  lb = BIT4_1;
-		  break;
-	    }
-
-	    if (rb != BIT4_1)
-		  lb = BIT4_X;
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
-
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, ~val.reduce_and());
       return true;
 }
 
@@ -4667,22 +4699,8 @@ bool of_NANDR(vthread_t thr, vvp_code_t)
  */
 bool of_ORR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_0;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1) {
-		  lb = BIT4_1;
-		  break;
-	    }
-
-	    if (rb != BIT4_0)
-		  lb = BIT4_X;
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, val.reduce_or());
       return true;
 }
 
@@ -4691,22 +4709,8 @@ bool of_ORR(vthread_t thr, vvp_code_t)
  */
 bool of_XORR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_0;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1)
-		  lb = ~lb;
-	    else if (rb != BIT4_0) {
-		  lb = BIT4_X;
-		  break;
-	    }
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, val.reduce_xor());
       return true;
 }
 
@@ -4715,22 +4719,8 @@ bool of_XORR(vthread_t thr, vvp_code_t)
  */
 bool of_XNORR(vthread_t thr, vvp_code_t)
 {
-      vvp_vector4_t val = thr->pop_vec4();
-
-      vvp_bit4_t lb = BIT4_1;
-      for (unsigned idx = 0 ; idx < val.size() ; idx += 1) {
-
-	    vvp_bit4_t rb = val.value(idx);
-	    if (rb == BIT4_1)
-		  lb = ~lb;
-	    else if (rb != BIT4_0) {
-		  lb = BIT4_X;
-		  break;
-	    }
-      }
-
-      vvp_vector4_t res (1, lb);
-      thr->push_vec4(res);
+      vvp_vector4_t&val = thr->peek_vec4();
+      val = vvp_vector4_t(1, ~val.reduce_xor());
       return true;
 }
 
@@ -5740,7 +5730,7 @@ bool of_SHIFTR(vthread_t thr, vvp_code_t cp)
       int use_index = cp->number;
       uint64_t shift = thr->words[use_index].w_uint;
 
-      vvp_vector4_t val = thr->pop_vec4();
+      vvp_vector4_t&val = thr->peek_vec4();
       unsigned wid  = val.size();
 
       if (thr->flags[4] == BIT4_1) {
@@ -5756,7 +5746,6 @@ bool of_SHIFTR(vthread_t thr, vvp_code_t cp)
 	    val.set_vec(wid-shift, tmp);
       }
 
-      thr->push_vec4(val);
       return true;
 }
 
@@ -5768,7 +5757,7 @@ bool of_SHIFTR_S(vthread_t thr, vvp_code_t cp)
       int use_index = cp->number;
       uint64_t shift = thr->words[use_index].w_uint;
 
-      vvp_vector4_t val = thr->pop_vec4();
+      vvp_vector4_t&val = thr->peek_vec4();
       unsigned wid  = val.size();
 
       vvp_bit4_t sign_bit = val.value(val.size()-1);
@@ -5786,7 +5775,6 @@ bool of_SHIFTR_S(vthread_t thr, vvp_code_t cp)
 	    val.set_vec(wid-shift, tmp);
       }
 
-      thr->push_vec4(val);
       return true;
 }
 
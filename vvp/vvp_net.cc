@@ -25,6 +25,8 @@
 # include  "resolv.h"
 # include  "schedule.h"
 # include  "statistics.h"
+# include  "slab.h"
+# include  "vec4_kernels.h"
 # include  <cstdio>
 # include  <cstring>
 # include  <cstdlib>
@@ -51,10 +53,25 @@ using namespace std;
 permaheap vvp_net_fun_t::heap_;
 permaheap vvp_net_fil_t::heap_;
 
+#ifdef USE_COMPACT_NETS
+// The chunks are the arenas of the compact net store.
+static const size_t VVP_NET_CHUNK = VVP_NET_ARENA_SIZE;
+// The arena table, indexed by the arena number in a net index. Arena
+// 0 is kept nil so that the nil vvp_net_ptr_t maps to a nil pointer.
+static vvp_net_t*vvp_net_arena_nil = 0;
+vvp_net_t**vvp_net_arena = &vvp_net_arena_nil;
+// The index of the net that operator new just allocated, for the
+// constructor to keep. The storage must not be written to before the
+// constructor runs.
+static uint32_t vvp_net_new_index = 0;
+#else
 // Allocate around 1Megabyte/chunk.
 static const size_t VVP_NET_CHUNK = 1024*1024/sizeof(vvp_net_t);
+#endif
 static vvp_net_t*vvp_net_alloc_table = NULL;
-#ifdef CHECK_WITH_VALGRIND
+#if defined(CHECK_WITH_VALGRIND) || defined(USE_COMPACT_NETS)
+// Keep the allocated chunks, to number them for the compact nets and
+// to free them for valgrind.
 static vvp_net_t **vvp_net_pool = NULL;
 static unsigned vvp_net_pool_count = 0;
 #endif
@@ -71,13 +88,25 @@ void* vvp_net_t::operator new (size_t size)
 	    vvp_net_alloc_table = ::new vvp_net_t[VVP_NET_CHUNK];
 	    vvp_net_alloc_remaining = VVP_NET_CHUNK;
 	    size_vvp_nets += size*VVP_NET_CHUNK;
-#ifdef CHECK_WITH_VALGRIND
-	    VALGRIND_MAKE_MEM_NOACCESS(vvp_net_alloc_table, size*VVP_NET_CHUNK);
-	    VALGRIND_CREATE_MEMPOOL(vvp_net_alloc_table, 0, 0);
+#if defined(CHECK_WITH_VALGRIND) || defined(USE_COMPACT_NETS)
 	    vvp_net_pool_count += 1;
 	    vvp_net_pool = (vvp_net_t **) realloc(vvp_net_pool,
 	                   vvp_net_pool_count*sizeof(vvp_net_t **));
 	    vvp_net_pool[vvp_net_pool_count-1] = vvp_net_alloc_table;
+#endif
+#ifdef USE_COMPACT_NETS
+	      // The net index has 30 bits, after the 2 port bits.
+	    assert(vvp_net_pool_count < (1UL << (30-VVP_NET_ARENA_SHIFT)));
+	    if (vvp_net_arena == &vvp_net_arena_nil)
+		  vvp_net_arena = 0;
+	    vvp_net_arena = (vvp_net_t**) realloc(vvp_net_arena,
+			    (vvp_net_pool_count+1)*sizeof(vvp_net_t*));
+	    vvp_net_arena[0] = 0;
+	    vvp_net_arena[vvp_net_pool_count] = vvp_net_alloc_table;
+#endif
+#ifdef CHECK_WITH_VALGRIND
+	    VALGRIND_MAKE_MEM_NOACCESS(vvp_net_alloc_table, size*VVP_NET_CHUNK);
+	    VALGRIND_CREATE_MEMPOOL(vvp_net_alloc_table, 0, 0);
 #endif
       }
 
@@ -86,6 +115,10 @@ void* vvp_net_t::operator new (size_t size)
       VALGRIND_MEMPOOL_ALLOC(vvp_net_pool[vvp_net_pool_count-1],
                              return_this, size);
       return_this->pool = vvp_net_pool[vvp_net_pool_count-1];
+#endif
+#ifdef USE_COMPACT_NETS
+      vvp_net_new_index = (vvp_net_pool_count << VVP_NET_ARENA_SHIFT)
+	    | (VVP_NET_CHUNK - vvp_net_alloc_remaining);
 #endif
       vvp_net_alloc_table += 1;
       vvp_net_alloc_remaining -= 1;
@@ -181,6 +214,11 @@ void vvp_net_pool_delete()
       free(vvp_net_pool);
       vvp_net_pool = NULL;
       vvp_net_pool_count = 0;
+#ifdef USE_COMPACT_NETS
+      if (vvp_net_arena != &vvp_net_arena_nil)
+	    free(vvp_net_arena);
+      vvp_net_arena = &vvp_net_arena_nil;
+#endif
 }
 #endif
 
@@ -189,11 +227,25 @@ void vvp_net_t::operator delete(void*)
       assert(0);
 }
 
+#ifdef USE_COMPACT_NETS
+ostream& operator << (ostream&out, vvp_net_ptr_t val)
+{
+      out << val.ptr() << "[" << val.port() << "]";
+      return out;
+}
+#endif
+
 vvp_net_t::vvp_net_t()
 : out_(vvp_net_ptr_t(0,0))
 {
       fun = 0;
       fil = 0;
+#ifdef USE_COMPACT_NETS
+	// The nets are only made by operator new, which sets the index.
+	// (The constructor also runs on each net when the arena itself
+	// is made, and then the index is set again later.)
+      index_ = vvp_net_new_index;
+#endif
 }
 
 void vvp_net_t::link(vvp_net_ptr_t port_to_link)
@@ -693,6 +745,64 @@ void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
       }
 }
 
+/*
+ * Vectors that are a few words wide are very common (64..256 bit
+ * values on a 64bit host) and are constantly created and destroyed
+ * as temporaries. Keep the word arrays for these widths in slab
+ * pools so that they do not go through the general heap. The pools
+ * are function statics so that they are constructed before any
+ * static vector that might use them.
+ */
+#ifndef CHECK_WITH_VALGRIND
+static const size_t VEC4_WORDS_CHUNK_BYTES = 8192;
+
+template <unsigned CNT> static inline
+slab_t<2*CNT*sizeof(unsigned long),
+       VEC4_WORDS_CHUNK_BYTES/(2*CNT*sizeof(unsigned long))>& vec4_words_heap()
+{
+      static slab_t<2*CNT*sizeof(unsigned long),
+		    VEC4_WORDS_CHUNK_BYTES/(2*CNT*sizeof(unsigned long))> heap;
+      return heap;
+}
+#endif
+
+unsigned long* vvp_vector4_t::alloc_words_(unsigned cnt)
+{
+#ifndef CHECK_WITH_VALGRIND
+      switch (cnt) {
+	  case 2:
+	    return static_cast<unsigned long*>(vec4_words_heap<2>().alloc_slab());
+	  case 3:
+	    return static_cast<unsigned long*>(vec4_words_heap<3>().alloc_slab());
+	  case 4:
+	    return static_cast<unsigned long*>(vec4_words_heap<4>().alloc_slab());
+	  default:
+	    break;
+      }
+#endif
+      return new unsigned long[2*cnt];
+}
+
+void vvp_vector4_t::release_words_(unsigned long*ptr, unsigned cnt)
+{
+#ifndef CHECK_WITH_VALGRIND
+      switch (cnt) {
+	  case 2:
+	    vec4_words_heap<2>().free_slab(ptr);
+	    return;
+	  case 3:
+	    vec4_words_heap<3>().free_slab(ptr);
+	    return;
+	  case 4:
+	    vec4_words_heap<4>().free_slab(ptr);
+	    return;
+	  default:
+	    break;
+      }
+#endif
+      delete[]ptr;
+}
+
 /*
  * This function should ONLY BE CALLED FROM vvp_vector4_t::copy_from_,
  * as it performs part of that functions tasks.
@@ -700,7 +810,7 @@ void vvp_vector4_t::copy_bits(const vvp_vector4_t&that)
 void vvp_vector4_t::copy_from_big_(const vvp_vector4_t&that)
 {
       unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
-      abits_ptr_ = new unsigned long[2*words];
+      abits_ptr_ = alloc_words_(words);
       bbits_ptr_ = abits_ptr_ + words;
 
       for (unsigned idx = 0 ;  idx < words ;  idx += 1)
@@ -719,7 +829,7 @@ void vvp_vector4_t::copy_inverted_from_(const vvp_vector4_t&that)
       size_ = that.size_;
       if (size_ > BITS_PER_WORD) {
 	    unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
-	    abits_ptr_ = new unsigned long[2*words];
+	    abits_ptr_ = alloc_words_(words);
 	    bbits_ptr_ = abits_ptr_ + words;
 
 	    unsigned remaining = size_;
@@ -749,7 +859,7 @@ void vvp_vector4_t::allocate_words_(unsigned long inita, unsigned long initb)
 {
       if (size_ > BITS_PER_WORD) {
 	    unsigned cnt = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    abits_ptr_ = new unsigned long[2*cnt];
+	    abits_ptr_ = alloc_words_(cnt);
 	    bbits_ptr_ = abits_ptr_ + cnt;
 	    for (unsigned idx = 0 ;  idx < cnt ;  idx += 1)
 		  abits_ptr_[idx] = inita;
@@ -999,7 +1109,7 @@ void vvp_vector4_t::resize(unsigned newsize, vvp_bit4_t pad_bit)
 		  return;
 	    }
 
-	    unsigned long*newbits = new unsigned long[2*newcnt];
+	    unsigned long*newbits = alloc_words_(newcnt);
 
 	    if (cnt > 1) {
 		  unsigned trans = cnt;
@@ -1011,7 +1121,7 @@ void vvp_vector4_t::resize(unsigned newsize, vvp_bit4_t pad_bit)
 		  for (unsigned idx = 0 ;  idx < trans ;  idx += 1)
 			newbits[newcnt+idx] = bbits_ptr_[idx];
 
-		  delete[]abits_ptr_;
+		  release_words_(abits_ptr_, cnt);
 
 	    } else {
 		  newbits[0] = abits_val_;
@@ -1039,7 +1149,7 @@ void vvp_vector4_t::resize(unsigned newsize, vvp_bit4_t pad_bit)
 	    if (cnt > 1) {
 		  unsigned long newvala = abits_ptr_[0];
 		  unsigned long newvalb = bbits_ptr_[0];
-		  delete[]abits_ptr_;
+		  release_words_(abits_ptr_, cnt);
 		  abits_val_ = newvala;
 		  bbits_val_ = newvalb;
 	    }
@@ -1730,12 +1840,9 @@ bool vvp_vector4_t::eeq(const vvp_vector4_t&that) const
       }
 
       unsigned words = size_ / BITS_PER_WORD;
-      for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
-	    if (abits_ptr_[idx] != that.abits_ptr_[idx])
-		  return false;
-	    if (bbits_ptr_[idx] != that.bbits_ptr_[idx])
-		  return false;
-      }
+      if (! vec4_kernels->eeq_words(abits_ptr_, bbits_ptr_,
+				    that.abits_ptr_, that.bbits_ptr_, words))
+	    return false;
 
       unsigned long mask = size_%BITS_PER_WORD;
       if (mask > 0) {
@@ -1764,12 +1871,9 @@ bool vvp_vector4_t::eq_xz(const vvp_vector4_t&that) const
       }
 
       unsigned words = size_ / BITS_PER_WORD;
-      for (unsigned idx = 0 ;  idx < words ;  idx += 1) {
-	    if ((abits_ptr_[idx]|bbits_ptr_[idx]) != (that.abits_ptr_[idx]|that.bbits_ptr_[idx]))
-		  return false;
-	    if (bbits_ptr_[idx] != that.bbits_ptr_[idx])
-		  return false;
-      }
+      if (! vec4_kernels->eq_xz_words(abits_ptr_, bbits_ptr_,
+				      that.abits_ptr_, that.bbits_ptr_, words))
+	    return false;
 
       unsigned long mask = size_%BITS_PER_WORD;
       if (mask > 0) {
@@ -1793,10 +1897,8 @@ bool vvp_vector4_t::has_xz() const
       }
 
       unsigned words = size_ / BITS_PER_WORD;
-      for (unsigned idx = 0 ; idx < words ; idx += 1) {
-	    if (bbits_ptr_[idx])
-		  return true;
-      }
+      if (vec4_kernels->any_words(bbits_ptr_, words))
+	    return true;
 
       unsigned long mask = size_%BITS_PER_WORD;
       if (mask > 0) {
@@ -1807,6 +1909,90 @@ bool vvp_vector4_t::has_xz() const
       return false;
 }
 
+void vvp_vector4_t::get_vecval(s_vpi_vecval*vec) const
+{
+      const unsigned long*ap = size_ > BITS_PER_WORD? abits_ptr_ : &abits_val_;
+      const unsigned long*bp = size_ > BITS_PER_WORD? bbits_ptr_ : &bbits_val_;
+
+	// The a/b encoding is the same as the aval/bval encoding, so
+	// this just cuts the words into 32bit pieces.
+      unsigned cnt = (size_ + 31) / 32;
+      for (unsigned idx = 0 ; idx < cnt ; idx += 1) {
+	    unsigned wdx = idx*32 / BITS_PER_WORD;
+	    unsigned off = idx*32 % BITS_PER_WORD;
+	    vec[idx].aval = (PLI_INT32)(ap[wdx] >> off);
+	    vec[idx].bval = (PLI_INT32)(bp[wdx] >> off);
+      }
+
+      unsigned tail = size_ % 32;
+      if (tail > 0) {
+	    PLI_INT32 mask = (PLI_INT32)((1U << tail) - 1);
+	    vec[cnt-1].aval &= mask;
+	    vec[cnt-1].bval &= mask;
+      }
+}
+
+void vvp_vector4_t::set_vecval(const s_vpi_vecval*vec)
+{
+      unsigned long*ap = size_ > BITS_PER_WORD? abits_ptr_ : &abits_val_;
+      unsigned long*bp = size_ > BITS_PER_WORD? bbits_ptr_ : &bbits_val_;
+
+      unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+      for (unsigned wdx = 0 ; wdx < words ; wdx += 1) {
+	    ap[wdx] = 0;
+	    bp[wdx] = 0;
+      }
+
+      unsigned cnt = (size_ + 31) / 32;
+      for (unsigned idx = 0 ; idx < cnt ; idx += 1) {
+	    unsigned wdx = idx*32 / BITS_PER_WORD;
+	    unsigned off = idx*32 % BITS_PER_WORD;
+	    ap[wdx] |= (unsigned long)(PLI_UINT32)vec[idx].aval << off;
+	    bp[wdx] |= (unsigned long)(PLI_UINT32)vec[idx].bval << off;
+      }
+
+      unsigned tail = size_ % BITS_PER_WORD;
+      if (tail > 0) {
+	    unsigned long mask = (1UL << tail) - 1;
+	    ap[words-1] &= mask;
+	    bp[words-1] &= mask;
+      }
+}
+
+void vvp_vector4_t::get_words(const unsigned long*&abits,
+			      const unsigned long*&bbits) const
+{
+      abits = size_ > BITS_PER_WORD? abits_ptr_ : &abits_val_;
+      bbits = size_ > BITS_PER_WORD? bbits_ptr_ : &bbits_val_;
+}
+
+void vvp_vector4_t::set_words(const unsigned long*abits,
+			      const unsigned long*bbits)
+{
+      if (size_ == 0)
+	    return;
+
+      if (size_ <= BITS_PER_WORD) {
+	    abits_val_ = abits[0];
+	    bbits_val_ = bbits[0];
+      } else {
+	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	    memcpy(abits_ptr_, abits, words*sizeof(unsigned long));
+	    memcpy(bbits_ptr_, bbits, words*sizeof(unsigned long));
+      }
+
+	// Keep the unused high bits clear like the other methods.
+      unsigned tail = size_ % BITS_PER_WORD;
+      if (tail > 0) {
+	    unsigned long mask = (1UL << tail) - 1;
+	    unsigned last = (size_ - 1) / BITS_PER_WORD;
+	    unsigned long*ap = size_ > BITS_PER_WORD? abits_ptr_ : &abits_val_;
+	    unsigned long*bp = size_ > BITS_PER_WORD? bbits_ptr_ : &bbits_val_;
+	    ap[last] &= mask;
+	    bp[last] &= mask;
+      }
+}
+
 void vvp_vector4_t::change_z2x()
 {
 	// This method relies on the fact that both BIT4_X and BIT4_Z
@@ -1819,8 +2005,7 @@ void vvp_vector4_t::change_z2x()
 	    abits_val_ |= bbits_val_;
       } else {
 	    unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
-	    for (unsigned idx = 0 ;  idx < words ;  idx += 1)
-		  abits_ptr_[idx] |= bbits_ptr_[idx];
+	    vec4_kernels->or_into_words(abits_ptr_, bbits_ptr_, words);
       }
 }
 
@@ -1906,14 +2091,8 @@ vvp_vector4_t& vvp_vector4_t::operator &= (const vvp_vector4_t&that)
 	    bbits_val_ = (tmp1 & that.bbits_val_) | (tmp2 & bbits_val_);
       } else {
 	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    for (unsigned idx = 0; idx < words ; idx += 1) {
-		  unsigned long tmp1 = abits_ptr_[idx] | bbits_ptr_[idx];
-		  unsigned long tmp2 = that.abits_ptr_[idx] |
-		                       that.bbits_ptr_[idx];
-		  abits_ptr_[idx] = tmp1 & tmp2;
-		  bbits_ptr_[idx] = (tmp1 & that.bbits_ptr_[idx]) |
-		                    (tmp2 & bbits_ptr_[idx]);
-	    }
+	    vec4_kernels->and_words(abits_ptr_, bbits_ptr_,
+				    that.abits_ptr_, that.bbits_ptr_, words);
       }
 
       return *this;
@@ -1936,20 +2115,82 @@ vvp_vector4_t& vvp_vector4_t::operator |= (const vvp_vector4_t&that)
 
       } else {
 	    unsigned words = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
-	    for (unsigned idx = 0; idx < words ; idx += 1) {
-		  unsigned long tmp = abits_ptr_[idx] | bbits_ptr_[idx] |
-	                        that.abits_ptr_[idx] | that.bbits_ptr_[idx];
-		  bbits_ptr_[idx] = ((~abits_ptr_[idx] | bbits_ptr_[idx]) &
-		                     that.bbits_ptr_[idx]) |
-		                    ((~that.abits_ptr_[idx] |
-		                      that.bbits_ptr_[idx]) & bbits_ptr_[idx]);
-		  abits_ptr_[idx] = tmp;
-	    }
+	    vec4_kernels->or_words(abits_ptr_, bbits_ptr_,
+				   that.abits_ptr_, that.bbits_ptr_, words);
       }
 
       return *this;
 }
 
+/*
+ * The reduction operators summarize all the bits of the vector with
+ * a single scan over the words, instead of combining the bits one
+ * at a time.
+ */
+void vvp_vector4_t::scan_bits_(vec4_scan_s&res) const
+{
+      res.zeros = 0;
+      res.ones = 0;
+      res.xz = 0;
+      res.parity = 0;
+
+      unsigned long abits, bbits;
+      if (size_ <= BITS_PER_WORD) {
+	    if (size_ == 0)
+		  return;
+	    abits = abits_val_;
+	    bbits = bbits_val_;
+
+      } else {
+	    unsigned words = (size_-1) / BITS_PER_WORD;
+	    vec4_kernels->scan_words(abits_ptr_, bbits_ptr_, words, res);
+	    abits = abits_ptr_[words];
+	    bbits = bbits_ptr_[words];
+      }
+
+	// Only the valid bits of the last word count.
+      unsigned long mask = -1UL >> (BITS_PER_WORD-1 - (size_-1)%BITS_PER_WORD);
+      res.zeros  |= mask & ~(abits | bbits);
+      res.ones   |= mask & abits & ~bbits;
+      res.xz     |= mask & bbits;
+      res.parity ^= mask & abits;
+}
+
+vvp_bit4_t vvp_vector4_t::reduce_and() const
+{
+      vec4_scan_s res;
+      scan_bits_(res);
+      if (res.zeros)
+	    return BIT4_0;
+      if (res.xz)
+	    return BIT4_X;
+      return BIT4_1;
+}
+
+vvp_bit4_t vvp_vector4_t::reduce_or() const
+{
+      vec4_scan_s res;
+      scan_bits_(res);
+      if (res.ones)
+	    return BIT4_1;
+      if (res.xz)
+	    return BIT4_X;
+      return BIT4_0;
+}
+
+vvp_bit4_t vvp_vector4_t::reduce_xor() const
+{
+      vec4_scan_s res;
+      scan_bits_(res);
+      if (res.xz)
+	    return BIT4_X;
+
+      unsigned long parity = res.parity;
+      for (unsigned shift = BITS_PER_WORD/2 ; shift > 0 ; shift /= 2)
+	    parity ^= parity >> shift;
+      return (parity & 1UL)? BIT4_1 : BIT4_0;
+}
+
 /*
 * Add an integer to the vvp_vector4_t in place, bit by bit so that
 * there is no size limitations.
@@ -2202,6 +2443,62 @@ vvp_vector4_t vvp_vector4array_t::get_word_(v4cell*cell) const
       return res;
 }
 
+void vvp_vector4array_t::set_words_(v4cell*cell, unsigned count,
+				    const unsigned long*abits,
+				    const unsigned long*bbits)
+{
+      unsigned cnt = (width_ + vvp_vector4_t::BITS_PER_WORD-1)/vvp_vector4_t::BITS_PER_WORD;
+      unsigned tail = width_ % vvp_vector4_t::BITS_PER_WORD;
+      unsigned long mask = tail? (1UL << tail) - 1 : ~0UL;
+
+      for (unsigned idx = 0 ; idx < count ; idx += 1, cell += 1) {
+	    if (width_ <= vvp_vector4_t::BITS_PER_WORD) {
+		  cell->abits_val_ = abits[0] & mask;
+		  cell->bbits_val_ = bbits[0] & mask;
+	    } else {
+		  if (cell->abits_ptr_ == 0) {
+			cell->abits_ptr_ = new unsigned long[2*cnt];
+			cell->bbits_ptr_ = cell->abits_ptr_ + cnt;
+		  }
+		  memcpy(cell->abits_ptr_, abits, cnt*sizeof(unsigned long));
+		  memcpy(cell->bbits_ptr_, bbits, cnt*sizeof(unsigned long));
+		  cell->abits_ptr_[cnt-1] &= mask;
+		  cell->bbits_ptr_[cnt-1] &= mask;
+	    }
+	    abits += cnt;
+	    bbits += cnt;
+      }
+}
+
+void vvp_vector4array_t::get_words_(const v4cell*cell, unsigned count,
+				    unsigned long*abits,
+				    unsigned long*bbits) const
+{
+      unsigned cnt = (width_ + vvp_vector4_t::BITS_PER_WORD-1)/vvp_vector4_t::BITS_PER_WORD;
+      unsigned tail = width_ % vvp_vector4_t::BITS_PER_WORD;
+      unsigned long mask = tail? (1UL << tail) - 1 : ~0UL;
+
+      for (unsigned idx = 0 ; idx < count ; idx += 1, cell += 1) {
+	    if (width_ <= vvp_vector4_t::BITS_PER_WORD) {
+		  abits[0] = cell->abits_val_;
+		  bbits[0] = cell->bbits_val_;
+	    } else if (cell->abits_ptr_ == 0) {
+		    // A word that was never written is all X.
+		  for (unsigned wdx = 0 ; wdx < cnt ; wdx += 1) {
+			abits[wdx] = vvp_vector4_t::WORD_X_ABITS;
+			bbits[wdx] = vvp_vector4_t::WORD_X_BBITS;
+		  }
+	    } else {
+		  memcpy(abits, cell->abits_ptr_, cnt*sizeof(unsigned long));
+		  memcpy(bbits, cell->bbits_ptr_, cnt*sizeof(unsigned long));
+	    }
+	    abits[cnt-1] &= mask;
+	    bbits[cnt-1] &= mask;
+	    abits += cnt;
+	    bbits += cnt;
+      }
+}
+
 vvp_vector4array_sa::vvp_vector4array_sa(unsigned width__, unsigned words__)
 : vvp_vector4array_t(width__, words__)
 {
@@ -2253,6 +2550,22 @@ vvp_vector4_t vvp_vector4array_sa::get_word(unsigned index) const
       return get_word_(cell);
 }
 
+void vvp_vector4array_sa::set_words(unsigned index, unsigned count,
+				    const unsigned long*abits,
+				    const unsigned long*bbits)
+{
+      assert(index + count <= words_);
+      set_words_(&array_[index], count, abits, bbits);
+}
+
+void vvp_vector4array_sa::get_words(unsigned index, unsigned count,
+				    unsigned long*abits,
+				    unsigned long*bbits) const
+{
+      assert(index + count <= words_);
+      get_words_(&array_[index], count, abits, bbits);
+}
+
 vvp_vector4array_aa::vvp_vector4array_aa(unsigned width__, unsigned words__)
 : vvp_vector4array_t(width__, words__)
 {
@@ -2339,6 +2652,30 @@ vvp_vector4_t vvp_vector4array_aa::get_word(unsigned index) const
       return get_word_(cell);
 }
 
+void vvp_vector4array_aa::set_words(unsigned index, unsigned count,
+				    const unsigned long*abits,
+				    const unsigned long*bbits)
+{
+      assert(index + count <= words_);
+
+      v4cell*cell = static_cast<v4cell*>
+            (vthread_get_wt_context_item(context_idx_)) + index;
+
+      set_words_(cell, count, abits, bbits);
+}
+
+void vvp_vector4array_aa::get_words(unsigned index, unsigned count,
+				    unsigned long*abits,
+				    unsigned long*bbits) const
+{
+      assert(index + count <= words_);
+
+      v4cell*cell = static_cast<v4cell*>
+            (vthread_get_rd_context_item(context_idx_)) + index;
+
+      get_words_(cell, count, abits, bbits);
+}
+
 vvp_vector2_t::vvp_vector2_t()
 {
       vec_ = 0;
@@ -3048,6 +3385,66 @@ ostream& operator<< (ostream&out, const vvp_vector2_t&that)
       return out;
 }
 
+/*
+ * A vvp_vector8_t holds one raw vvp_scalar_t byte per bit. The whole
+ * vector operations below work on a word of these bytes at a time,
+ * treating each byte of the word as a lane. Conditions on lanes are
+ * computed into bit 7 of each lane, and expanded to whole lane masks
+ * where needed.
+ *
+ * Moving bits between a vvp_vector4_t and lanes depends on the order
+ * of the bytes in a word, so those only use lanes on little-endian
+ * hosts. The lane-wise operations work with any byte order.
+ */
+static const unsigned V8_LANES = sizeof(unsigned long);
+static const unsigned long V8_ONES = ~0UL / 0xff;
+static const unsigned long V8_MSB = V8_ONES * 0x80;
+static const unsigned long V8_LOW7 = V8_ONES * 0x7f;
+static const unsigned long V8_STREN = V8_ONES * 0x77;
+#if SIZEOF_UNSIGNED_LONG == 8
+static const unsigned long V8_GATHER = 0x0102040810204080UL;
+#elif SIZEOF_UNSIGNED_LONG == 4
+static const unsigned long V8_GATHER = 0x10204080UL;
+#else
+#error "V8_GATHER not defined for this architecture?"
+#endif
+
+  // Set bit 7 of every lane that is not zero.
+static inline unsigned long v8_lanes_nonzero(unsigned long val)
+{
+      return (((val & V8_LOW7) + V8_LOW7) | val) & V8_MSB;
+}
+
+  // Expand bit 7 of each lane to the whole lane.
+static inline unsigned long v8_lanes_mask(unsigned long flags)
+{
+      return (flags >> 7) * 0xff;
+}
+
+#ifndef WORDS_BIGENDIAN
+  // Collect bit 7 of each lane into the low V8_LANES bits.
+static inline unsigned long v8_lanes_gather(unsigned long flags)
+{
+      return ((flags >> 7) * V8_GATHER) >> (8*sizeof(unsigned long) - V8_LANES);
+}
+
+static inline unsigned long v8_spread4(unsigned long bits)
+{
+      return ((bits & 0xfUL) * 0x204081UL) & 0x01010101UL;
+}
+
+  // Make a lane mask from the low V8_LANES bits, one bit per lane.
+static inline unsigned long v8_lanes_spread(unsigned long bits)
+{
+#if SIZEOF_UNSIGNED_LONG == 8
+      unsigned long lanes = v8_spread4(bits) | (v8_spread4(bits >> 4) << 32);
+#else
+      unsigned long lanes = v8_spread4(bits);
+#endif
+      return lanes * 0xff;
+}
+#endif
+
 vvp_vector8_t::vvp_vector8_t(const vvp_vector8_t&that)
 {
       size_ = that.size_;
@@ -3066,15 +3463,39 @@ vvp_vector8_t::vvp_vector8_t(const vvp_vector4_t&that,
       if (size_ == 0)
 	    return;
 
-      if (size_ <= sizeof(val_)) {
+      if (size_ <= sizeof(val_))
 	    ptr_ = 0; // Prefill all val_ bytes
-	    for (unsigned idx = 0 ; idx < size_ ; idx += 1)
-		  val_[idx] = vvp_scalar_t(that.value(idx),str0, str1).raw();
-      } else {
+      else
 	    ptr_ = new unsigned char[size_];
-	    for (unsigned idx = 0 ;  idx < size_ ;  idx += 1)
-		  ptr_[idx] = vvp_scalar_t(that.value(idx), str0, str1).raw();
-      }
+
+      unsigned char*dst = bytes_();
+
+#ifndef WORDS_BIGENDIAN
+	// Fill a word of lanes at a time with the scalar for each of
+	// the 0, 1 and X bits. The Z lanes are left 0.
+      const unsigned long lane0 = V8_ONES * vvp_scalar_t(BIT4_0, str0, str1).raw();
+      const unsigned long lane1 = V8_ONES * vvp_scalar_t(BIT4_1, str0, str1).raw();
+      const unsigned long laneX = V8_ONES * vvp_scalar_t(BIT4_X, str0, str1).raw();
+      const unsigned BPW = vvp_vector4_t::BITS_PER_WORD;
+      const unsigned long*abits = size_ > BPW? that.abits_ptr_ : &that.abits_val_;
+      const unsigned long*bbits = size_ > BPW? that.bbits_ptr_ : &that.bbits_val_;
+
+      for (unsigned base = 0 ; base < size_ ; base += V8_LANES) {
+	    unsigned shift = base % BPW;
+	    unsigned long amask = v8_lanes_spread(abits[base/BPW] >> shift);
+	    unsigned long bmask = v8_lanes_spread(bbits[base/BPW] >> shift);
+	    unsigned long lanes = (lane0 & ~amask & ~bmask)
+		                | (lane1 &  amask & ~bmask)
+		                | (laneX &  amask &  bmask);
+	    unsigned cnt = size_ - base;
+	    if (cnt > V8_LANES)
+		  cnt = V8_LANES;
+	    memcpy(dst+base, &lanes, cnt);
+      }
+#else
+      for (unsigned idx = 0 ;  idx < size_ ;  idx += 1)
+	    dst[idx] = vvp_scalar_t(that.value(idx), str0, str1).raw();
+#endif
 }
 
 vvp_vector8_t::vvp_vector8_t(const vvp_vector2_t&that,
@@ -3134,13 +3555,11 @@ vvp_vector8_t vvp_vector8_t::subvalue(unsigned base, unsigned wid) const
 {
       vvp_vector8_t tmp (wid);
 
-      unsigned char*tmp_ptr = tmp.size_ <= sizeof(val_) ? tmp.val_ : tmp.ptr_;
-      const unsigned char*use_ptr = size_ <= sizeof(val_) ? val_ : ptr_;
-
-      unsigned idx = 0;
-      while ((idx < wid) && (base+idx < size_)) {
-	    tmp_ptr[idx] = use_ptr[base+idx];
-	    idx += 1;
+      if (base < size_) {
+	    unsigned cnt = size_ - base;
+	    if (cnt > wid)
+		  cnt = wid;
+	    memcpy(tmp.bytes_(), bytes_()+base, cnt);
       }
 
       return tmp;
@@ -3149,8 +3568,7 @@ vvp_vector8_t vvp_vector8_t::subvalue(unsigned base, unsigned wid) const
 void vvp_vector8_t::set_vec(unsigned base, const vvp_vector8_t&that)
 {
       assert((base+that.size()) <= size());
-      for (unsigned idx = 0 ; idx < that.size() ; idx += 1)
-	    set_bit(base+idx, that.value(idx));
+      memcpy(bytes_()+base, that.bytes_(), that.size_);
 }
 
 vvp_vector8_t part_expand(const vvp_vector8_t&that, unsigned wid, unsigned off)
@@ -3158,17 +3576,10 @@ vvp_vector8_t part_expand(const vvp_vector8_t&that, unsigned wid, unsigned off)
       assert(off < wid);
       vvp_vector8_t tmp (wid);
 
-      unsigned char* tmp_ptr = tmp.size_<= sizeof(tmp.val_) ?
-                               tmp.val_ : tmp.ptr_;
-      const unsigned char* that_ptr = that.size_<= sizeof(that.val_) ?
-                                      that.val_ : that.ptr_;
-
-      unsigned idx = off;
-
-      while (idx < wid && that.size_ > (idx-off)) {
-	    tmp_ptr[idx] = that_ptr[idx-off];
-	    idx += 1;
-      }
+      unsigned cnt = wid - off;
+      if (cnt > that.size_)
+	    cnt = that.size_;
+      memcpy(tmp.bytes_()+off, that.bytes_(), cnt);
 
       return tmp;
 }
@@ -3714,11 +4125,97 @@ unsigned vvp_switch_strength_map[2][8] = {
       }
 };
 
+/*
+ * Resolve a word of lanes at a time. A HiZ lane takes the other
+ * value, and otherwise a lane takes the a value. That is the answer
+ * unless neither lane is HiZ and they differ, which needs the full
+ * resolution of the scalars.
+ */
+static inline bool v8_resolve_lanes(unsigned char*op, const unsigned char*ap,
+				    const unsigned char*bp, unsigned cnt)
+{
+      unsigned long aw = 0, bw = 0;
+      memcpy(&aw, ap, cnt);
+      memcpy(&bw, bp, cnt);
+
+      unsigned long a_nz = v8_lanes_nonzero(aw & V8_STREN);
+      unsigned long b_nz = v8_lanes_nonzero(bw & V8_STREN);
+      unsigned long diff = v8_lanes_nonzero(aw ^ bw);
+      unsigned long a_mask = v8_lanes_mask(a_nz);
+      unsigned long ow = (aw & a_mask) | (bw & ~a_mask);
+      memcpy(op, &ow, cnt);
+
+	// Return true if some lanes need the full resolution.
+      return (a_nz & b_nz & diff) != 0;
+}
+
+vvp_vector8_t resolve(const vvp_vector8_t&a, const vvp_vector8_t&b)
+{
+      assert(a.size() == b.size());
+      vvp_vector8_t out (a.size());
+
+      const unsigned char*ap = a.bytes_();
+      const unsigned char*bp = b.bytes_();
+      unsigned char*op = out.bytes_();
+
+      for (unsigned base = 0 ; base < out.size_ ; base += V8_LANES) {
+	    unsigned cnt = out.size_ - base;
+	    bool full = cnt >= V8_LANES
+		  ? v8_resolve_lanes(op+base, ap+base, bp+base, V8_LANES)
+		  : v8_resolve_lanes(op+base, ap+base, bp+base, cnt);
+	    if (! full)
+		  continue;
+
+	    if (cnt > V8_LANES)
+		  cnt = V8_LANES;
+	    for (unsigned idx = base ; idx < base+cnt ; idx += 1)
+		  out.set_bit(idx, resolve(a.value(idx), b.value(idx)));
+      }
+
+      return out;
+}
+
 vvp_vector4_t reduce4(const vvp_vector8_t&that)
 {
       vvp_vector4_t out (that.size());
+
+#ifndef WORDS_BIGENDIAN
+	// Convert a word of lanes at a time into a group of abits and
+	// bbits. A lane is Z if its strengths are both HiZ, and
+	// otherwise is 0 or 1 if bits 3 and 7 agree, or X if not.
+      const unsigned BPW = vvp_vector4_t::BITS_PER_WORD;
+      const unsigned char*ip = that.bytes_();
+      unsigned long*abits = out.size_ > BPW? out.abits_ptr_ : &out.abits_val_;
+      unsigned long*bbits = out.size_ > BPW? out.bbits_ptr_ : &out.bbits_val_;
+
+      for (unsigned base = 0 ; base < out.size_ ; base += V8_LANES) {
+	    unsigned long lanes;
+	    if (out.size_ - base >= V8_LANES) {
+		  memcpy(&lanes, ip+base, sizeof lanes);
+	    } else {
+		    // Lanes past the end become X, like the rest of
+		    // the unused bits of the new vector.
+		  memset(&lanes, 0xf7, sizeof lanes);
+		  memcpy(&lanes, ip+base, out.size_ - base);
+	    }
+
+	    unsigned long nz = v8_lanes_nonzero(lanes & V8_STREN);
+	    unsigned long lo = (lanes << 4) & V8_MSB;
+	    unsigned long hi = lanes & V8_MSB;
+	    unsigned long aflags = nz & (lo | hi);
+	    unsigned long bflags = (nz ^ V8_MSB) | (nz & (lo ^ hi));
+
+	    unsigned shift = base % BPW;
+	    unsigned long group = (1UL << V8_LANES) - 1UL;
+	    abits[base/BPW] &= ~(group << shift);
+	    abits[base/BPW] |= v8_lanes_gather(aflags) << shift;
+	    bbits[base/BPW] &= ~(group << shift);
+	    bbits[base/BPW] |= v8_lanes_gather(bflags) << shift;
+      }
+#else
       for (unsigned idx = 0 ;  idx < out.size() ;  idx += 1)
 	    out.set_bit(idx, that.value(idx).value());
+#endif
 
       return out;
 }
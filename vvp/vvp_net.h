@@ -238,9 +238,13 @@ extern unsigned long multiply_with_carry(unsigned long a, unsigned long b,
  * No strength values are stored here, if strengths are needed, use a
  * collection of vvp_scalar_t objects instead.
  */
+struct vec4_scan_s;
+
 class vvp_vector4_t {
 
       friend vvp_vector4_t operator ~(const vvp_vector4_t&that);
+      friend vvp_vector4_t reduce4(const class vvp_vector8_t&that);
+      friend class vvp_vector8_t;
       friend class vvp_vector4array_t;
       friend class vvp_vector4array_sa;
       friend class vvp_vector4array_aa;
@@ -264,9 +268,18 @@ class vvp_vector4_t {
       vvp_vector4_t(const vvp_vector4_t&that);
       vvp_vector4_t(const vvp_vector4_t&that, bool invert_flag);
       vvp_vector4_t& operator= (const vvp_vector4_t&that);
+# if __cplusplus >= 201103L
+	// Moving a vector steals the word arrays of that vector,
+	// leaving it empty (zero width).
+      vvp_vector4_t(vvp_vector4_t&&that) noexcept;
+      vvp_vector4_t& operator= (vvp_vector4_t&&that) noexcept;
+# endif
 
       ~vvp_vector4_t();
 
+	// Exchange the contents of two vectors without copying.
+      void swap(vvp_vector4_t&that);
+
       inline unsigned size() const { return size_; }
       void resize(unsigned new_size, vvp_bit4_t pad_bit = BIT4_X);
 
@@ -309,6 +322,21 @@ class vvp_vector4_t {
 	// Return true if there is an X or Z anywhere in the vector.
       bool has_xz() const;
 
+	// Copy the bits into a VPI vecval array, which must have
+	// room for (size()+31)/32 words. Unused high bits are 0.
+      void get_vecval(s_vpi_vecval*vec) const;
+	// Set the bits from a VPI vecval array of (size()+31)/32
+	// words. This is the reverse of get_vecval.
+      void set_vecval(const s_vpi_vecval*vec);
+
+	// Get read only pointers to the a and b words of the vector,
+	// (size()+BITS_PER_WORD-1)/BITS_PER_WORD words each. The bits
+	// above the size in the last word are undefined. The pointers
+	// are invalidated if the vector changes size.
+      void get_words(const unsigned long*&abits, const unsigned long*&bbits) const;
+	// Set all the bits from a and b word arrays of the same form.
+      void set_words(const unsigned long*abits, const unsigned long*bbits);
+
 	// Change all Z bits to X bits.
       void change_z2x();
 
@@ -323,6 +351,12 @@ class vvp_vector4_t {
       vvp_vector4_t& operator |= (const vvp_vector4_t&that);
       vvp_vector4_t& operator += (int64_t);
 
+	// The &, | and ^ reductions of all the bits of the vector.
+	// A zero width vector reduces to the identity of the operator.
+      vvp_bit4_t reduce_and() const;
+      vvp_bit4_t reduce_or() const;
+      vvp_bit4_t reduce_xor() const;
+
     private:
 	// Number of vvp_bit4_t bits that can be shoved into a word.
       enum { BITS_PER_WORD = 8*sizeof(unsigned long) };
@@ -354,6 +388,14 @@ class vvp_vector4_t {
 
       void allocate_words_(unsigned long inita, unsigned long initb);
 
+	// Get and release the storage for the a/b word arrays of a
+	// vector that has 'cnt' words. The abits are in the first
+	// 'cnt' words and the bbits in the second 'cnt' words.
+      static unsigned long*alloc_words_(unsigned cnt);
+      static void release_words_(unsigned long*ptr, unsigned cnt);
+
+      void scan_bits_(vec4_scan_s&res) const;
+
 	// Values in the vvp_vector4_t are stored split across two
 	// arrays. For each bit in the vector, there is an abit and a
 	// bbit. the encoding of a vvp_vector4_t is:
@@ -410,7 +452,7 @@ inline vvp_vector4_t::vvp_vector4_t(unsigned size__, vvp_bit4_t val)
 inline vvp_vector4_t::~vvp_vector4_t()
 {
       if (size_ > BITS_PER_WORD) {
-	    delete[] abits_ptr_;
+	    release_words_(abits_ptr_, (size_+BITS_PER_WORD-1) / BITS_PER_WORD);
 	      // bbits_ptr_ actually points half-way into a
 	      // double-length array started at abits_ptr_
       }
@@ -421,14 +463,87 @@ inline vvp_vector4_t& vvp_vector4_t::operator= (const vvp_vector4_t&that)
       if (this == &that)
 	    return *this;
 
-      if (size_ > BITS_PER_WORD)
-	    delete[] abits_ptr_;
+      if (size_ > BITS_PER_WORD) {
+	    unsigned words = (size_+BITS_PER_WORD-1) / BITS_PER_WORD;
+	      // If the width is unchanged, then reuse the words that
+	      // are already allocated.
+	    if (size_ == that.size_) {
+		  memcpy(abits_ptr_, that.abits_ptr_, words*sizeof(unsigned long));
+		  memcpy(bbits_ptr_, that.bbits_ptr_, words*sizeof(unsigned long));
+		  return *this;
+	    }
+	    release_words_(abits_ptr_, words);
+      }
 
       copy_from_(that);
 
       return *this;
 }
 
+# if __cplusplus >= 201103L
+inline vvp_vector4_t::vvp_vector4_t(vvp_vector4_t&&that) noexcept
+: size_(that.size_)
+{
+      if (size_ > BITS_PER_WORD) {
+	    abits_ptr_ = that.abits_ptr_;
+	    bbits_ptr_ = that.bbits_ptr_;
+      } else {
+	    abits_val_ = that.abits_val_;
+	    bbits_val_ = that.bbits_val_;
+      }
+      that.size_ = 0;
+}
+
+inline vvp_vector4_t& vvp_vector4_t::operator= (vvp_vector4_t&&that) noexcept
+{
+      if (this != &that) {
+	    swap(that);
+	      // The old contents (now in that) are released here
+	      // instead of waiting for that to be destroyed.
+	    if (that.size_ > BITS_PER_WORD)
+		  release_words_(that.abits_ptr_,
+				 (that.size_+BITS_PER_WORD-1) / BITS_PER_WORD);
+	    that.size_ = 0;
+      }
+      return *this;
+}
+# endif
+
+inline void vvp_vector4_t::swap(vvp_vector4_t&that)
+{
+	// The unions may hold either a pointer or a value, so
+	// exchange them as whatever the respective sizes say.
+      unsigned long*aptr = 0, *bptr = 0;
+      unsigned long aval = 0, bval = 0;
+      if (size_ > BITS_PER_WORD) {
+	    aptr = abits_ptr_;
+	    bptr = bbits_ptr_;
+      } else {
+	    aval = abits_val_;
+	    bval = bbits_val_;
+      }
+
+      if (that.size_ > BITS_PER_WORD) {
+	    abits_ptr_ = that.abits_ptr_;
+	    bbits_ptr_ = that.bbits_ptr_;
+      } else {
+	    abits_val_ = that.abits_val_;
+	    bbits_val_ = that.bbits_val_;
+      }
+
+      if (size_ > BITS_PER_WORD) {
+	    that.abits_ptr_ = aptr;
+	    that.bbits_ptr_ = bptr;
+      } else {
+	    that.abits_val_ = aval;
+	    that.bbits_val_ = bval;
+      }
+
+      unsigned tmp = size_;
+      size_ = that.size_;
+      that.size_ = tmp;
+}
+
 inline void vvp_vector4_t::copy_from_(const vvp_vector4_t&that)
 {
       size_ = that.size_;
@@ -586,6 +701,18 @@ class vvp_vector4array_t {
       virtual vvp_vector4_t get_word(unsigned idx) const = 0;
       virtual void set_word(unsigned idx, const vvp_vector4_t&that) = 0;
 
+	// Set or get count words starting at idx without making a
+	// vvp_vector4_t for each. The abits and bbits arrays hold the
+	// words one after another, each in the form that
+	// vvp_vector4_t::get_words() returns. The caller must keep
+	// idx+count within the array.
+      virtual void set_words(unsigned idx, unsigned count,
+			     const unsigned long*abits,
+			     const unsigned long*bbits) = 0;
+      virtual void get_words(unsigned idx, unsigned count,
+			     unsigned long*abits,
+			     unsigned long*bbits) const = 0;
+
     protected:
       struct v4cell {
 	    union {
@@ -600,6 +727,10 @@ class vvp_vector4array_t {
 
       vvp_vector4_t get_word_(v4cell*cell) const;
       void set_word_(v4cell*cell, const vvp_vector4_t&that);
+      void set_words_(v4cell*cell, unsigned count,
+		      const unsigned long*abits, const unsigned long*bbits);
+      void get_words_(const v4cell*cell, unsigned count,
+		      unsigned long*abits, unsigned long*bbits) const;
 
       unsigned width_;
       unsigned words_;
@@ -620,6 +751,10 @@ class vvp_vector4array_sa : public vvp_vector4array_t {
 
       vvp_vector4_t get_word(unsigned idx) const;
       void set_word(unsigned idx, const vvp_vector4_t&that);
+      void set_words(unsigned idx, unsigned count,
+		     const unsigned long*abits, const unsigned long*bbits);
+      void get_words(unsigned idx, unsigned count,
+		     unsigned long*abits, unsigned long*bbits) const;
 
     private:
       v4cell* array_;
@@ -642,6 +777,10 @@ class vvp_vector4array_aa : public vvp_vector4array_t, public automatic_hooks_s
 
       vvp_vector4_t get_word(unsigned idx) const;
       void set_word(unsigned idx, const vvp_vector4_t&that);
+      void set_words(unsigned idx, unsigned count,
+		     const unsigned long*abits, const unsigned long*bbits);
+      void get_words(unsigned idx, unsigned count,
+		     unsigned long*abits, unsigned long*bbits) const;
 
     private:
       unsigned context_idx_;
@@ -906,6 +1045,8 @@ extern std::ostream& operator<< (std::ostream&, vvp_scalar_t);
 class vvp_vector8_t {
 
       friend vvp_vector8_t part_expand(const vvp_vector8_t&, unsigned, unsigned);
+      friend vvp_vector8_t resolve(const vvp_vector8_t&, const vvp_vector8_t&);
+      friend vvp_vector4_t reduce4(const vvp_vector8_t&that);
 
     public:
       explicit vvp_vector8_t(unsigned size =0);
@@ -936,6 +1077,14 @@ class vvp_vector8_t {
       vvp_vector8_t(const vvp_vector8_t&that);
       vvp_vector8_t& operator= (const vvp_vector8_t&that);
 
+    private:
+	// The scalars are stored one raw byte per bit, either in
+	// val_ or in the array at ptr_. These return whichever it is.
+      unsigned char*bytes_()
+      { return size_ <= sizeof(val_)? val_ : ptr_; }
+      const unsigned char*bytes_() const
+      { return size_ <= sizeof(val_)? val_ : ptr_; }
+
     private:
       unsigned size_;
       union {
@@ -946,17 +1095,7 @@ class vvp_vector8_t {
 
   /* Resolve uses the default Verilog resolver algorithm to resolve
      two drive vectors to a single output. */
-inline vvp_vector8_t resolve(const vvp_vector8_t&a, const vvp_vector8_t&b)
-{
-      assert(a.size() == b.size());
-      vvp_vector8_t out (a.size());
-
-      for (unsigned idx = 0 ;  idx < out.size() ;  idx += 1) {
-	    out.set_bit(idx, resolve(a.value(idx), b.value(idx)));
-      }
-
-      return out;
-}
+extern vvp_vector8_t resolve(const vvp_vector8_t&a, const vvp_vector8_t&b);
 
   /* This lookup tabke implements the strength reduction implied by
      Verilog standard switch devices. The major dimension selects
@@ -1071,10 +1210,50 @@ template <class T> class vvp_sub_pointer_t {
       uintptr_t bits_;
 };
 
-typedef vvp_sub_pointer_t<vvp_net_t> vvp_net_ptr_t;
 template <class T> std::ostream& operator << (std::ostream&out, vvp_sub_pointer_t<T> val)
 { out << val.ptr() << "[" << val.port() << "]"; return out; }
 
+#ifdef USE_COMPACT_NETS
+/*
+ * With the compact net store, the vvp_net_t objects are allocated in
+ * arenas of VVP_NET_ARENA_SIZE nets, and a net is identified by a 32bit
+ * index (arena number and position in the arena) instead of a pointer.
+ * The vvp_net_ptr_t carries that index and the port number in 32 bits,
+ * which makes the ports and output of every net, and all the other
+ * places that keep a vvp_net_ptr_t, half the size.
+ *
+ * Arena 0 is never allocated and its table entry is nil, so the index
+ * 0 (the nil pointer) maps to a nil vvp_net_t* without a test.
+ */
+enum { VVP_NET_ARENA_SHIFT = 14,
+       VVP_NET_ARENA_SIZE = 1 << VVP_NET_ARENA_SHIFT };
+extern vvp_net_t**vvp_net_arena;
+
+class vvp_net_ptr_t {
+
+    public:
+      vvp_net_ptr_t() : bits_(0) { }
+      inline vvp_net_ptr_t(vvp_net_t*ptr__, unsigned port__);
+
+      inline vvp_net_t* ptr();
+      inline const vvp_net_t* ptr() const;
+
+      unsigned  port() const { return bits_ & 3U; }
+
+      bool nil() const { return bits_ == 0; }
+
+      bool operator == (vvp_net_ptr_t that) const { return bits_ == that.bits_; }
+      bool operator != (vvp_net_ptr_t that) const { return bits_ != that.bits_; }
+
+    private:
+      uint32_t bits_;
+};
+
+extern std::ostream& operator << (std::ostream&out, vvp_net_ptr_t val);
+#else
+typedef vvp_sub_pointer_t<vvp_net_t> vvp_net_ptr_t;
+#endif
+
 /*
  * This is the basic unit of netlist connectivity. It is a fan-in of
  * up to 4 inputs, and output pointer, and a pointer to the node's
@@ -1160,6 +1339,12 @@ class vvp_net_t {
 
     private:
       vvp_net_ptr_t out_;
+#ifdef USE_COMPACT_NETS
+	// The index of this net, from operator new through the
+	// constructor.
+      uint32_t index_;
+      friend class vvp_net_ptr_t;
+#endif
 
     public: // Need a better new for these objects.
       static void* operator new(std::size_t size);
@@ -1171,6 +1356,28 @@ class vvp_net_t {
 #endif
 };
 
+#ifdef USE_COMPACT_NETS
+inline vvp_net_ptr_t::vvp_net_ptr_t(vvp_net_t*ptr__, unsigned port__)
+{
+      assert( (port__ & ~3U) == 0 );
+      bits_ = ptr__? (ptr__->index_ << 2) | port__ : port__;
+}
+
+inline vvp_net_t* vvp_net_ptr_t::ptr()
+{
+      uint32_t idx = bits_ >> 2;
+      return vvp_net_arena[idx >> VVP_NET_ARENA_SHIFT]
+	    + (idx & (VVP_NET_ARENA_SIZE-1));
+}
+
+inline const vvp_net_t* vvp_net_ptr_t::ptr() const
+{
+      uint32_t idx = bits_ >> 2;
+      return vvp_net_arena[idx >> VVP_NET_ARENA_SHIFT]
+	    + (idx & (VVP_NET_ARENA_SIZE-1));
+}
+#endif
+
 /*
  * Instances of this class represent the functionality of a
  * node. vvp_net_t objects hold pointers to the vvp_net_fun_t
@@ -1396,6 +1603,7 @@ class vvp_fun_concat  : public vvp_net_fun_t {
                         vvp_context_t);
     private:
       unsigned wid_[4];
+      bool has_run_;
       vvp_vector4_t val_;
 };
 
@@ -117,6 +117,11 @@ double vvp_signal_value::real_value() const
       return 0;
 }
 
+const vvp_vector4_t* vvp_signal_value::vec4_value_ptr() const
+{
+      return 0;
+}
+
 void vvp_net_t::force_vec4(const vvp_vector4_t&val, const vvp_vector2_t&mask)
 {
       assert(fil);
@@ -1046,6 +1051,15 @@ void vvp_wire_vec4::vec4_value(vvp_vector4_t&val) const
 	    val.set_bit(idx, filtered_value_(idx));
 }
 
+const vvp_vector4_t* vvp_wire_vec4::vec4_value_ptr() const
+{
+	// A forced value is mixed into the driven value bit by bit,
+	// so only an unforced wire has the whole value in one place.
+      if (test_force_mask_is_zero())
+	    return &bits4_;
+      return 0;
+}
+
 vvp_bit4_t vvp_wire_vec4::driven_value(unsigned idx) const
 {
       return bits4_.value(idx);
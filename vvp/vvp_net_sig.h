@@ -101,6 +101,10 @@ class vvp_signal_value {
       virtual vvp_scalar_t scalar_value(unsigned idx) const =0;
       virtual void vec4_value(vvp_vector4_t&) const =0;
       virtual double real_value() const;
+	// Return a pointer to the vector that holds the present
+	// value, or nil if the value must be copied out through
+	// vec4_value. The pointer is good for the life of the signal.
+      virtual const vvp_vector4_t* vec4_value_ptr() const;
 
       virtual void get_signal_value(struct t_vpi_value*vp);
 };
@@ -446,6 +450,7 @@ class vvp_wire_vec4 : public vvp_wire_base {
       vvp_bit4_t value(unsigned idx) const;
       vvp_scalar_t scalar_value(unsigned idx) const;
       void vec4_value(vvp_vector4_t&) const;
+      const vvp_vector4_t* vec4_value_ptr() const;
 
         // Support for $countdrivers
       vvp_bit4_t driven_value(unsigned idx) const;